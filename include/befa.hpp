@@ -16,12 +16,21 @@
 #include "befa/assembly/basic_block.hpp"
 #include "befa/assembly/symbol.hpp"
 #include "befa/assembly/section.hpp"
+#include "befa/assembly/prefetcher.hpp"
+#include "befa/assembly/analysis.hpp"
+#include "befa/assembly/disassembly_visitor.hpp"
+#include "befa/assembly/parse_memo.hpp"
 
 namespace llvm {
 /**
  * defined in @see befa/llvm/instruction.hpp
  */
 struct InstructionMapper;
+
+/**
+ * defined in @see befa/llvm/function_cache.hpp
+ */
+struct FunctionCache;
 }
 
 /**
@@ -34,6 +43,12 @@ class disassembler_impl {
     void reset();
     std::string buffer;
     size_t pos;
+
+    /** Decoded instruction contains address (set by print_address_func) */
+    bool has_address;
+
+    /** The last address printed by print_address_func */
+    bfd_vma address;
   };
 
   // ~~~~~ Copy & Move semantics
@@ -56,7 +71,7 @@ class disassembler_impl {
 
   std::shared_ptr<ffile> fake_file = std::make_shared<ffile>();
 
-  std::vector<std::unique_ptr<uint8_t[]>> shared_buffer;
+  std::vector<std::shared_ptr<uint8_t[]>> shared_buffer;
 
   ~disassembler_impl() { if (_fd) bfd_close(_fd); }
  public:
@@ -94,6 +109,11 @@ class ExecutableFile
       llvm::InstructionMapper
   >;
 
+  using visitor_t = befa::DisassemblyVisitor<
+      sec_t::info::type, sym_t::info::type,
+      bb_t::info::type, inst_t::info::type
+  >;
+
   using var_t = type_traits::container<
       symbol_table::VisitableBase
   >;
@@ -151,6 +171,69 @@ class ExecutableFile
    */
   void runDisassembler();
 
+  /**
+   * Executes disassembler, structure of disassembly is reported to
+   * visitor (instructions are emitted into disassembly() as well)
+   * @param visitor receives begin/end of sections, symbols and basic blocks
+   */
+  void runDisassembler(visitor_t &visitor);
+
+  /**
+   * Limits amount of section contents read ahead of disassembler
+   * @param bytes read-ahead budget, 0 reads sections synchronously
+   */
+  void setPrefetchBudget(size_t bytes) { prefetch_budget = bytes; }
+
+  /**
+   * Streaming mode: limits memory used by section contents and releases
+   * basic blocks of symbol once its instructions has been emitted
+   *
+   * Emitted instructions then share ownership of their basic blocks and
+   * section contents, which are released once every copy of them held
+   * by subscribers is gone (only memory held by disassembler is counted
+   * into budget). Evicted sections are read again on demand.
+   *
+   * @param bytes memory budget, 0 keeps everything (default)
+   */
+  void setMemoryBudget(size_t bytes) { memory_budget = bytes; }
+
+  /**
+   * @return upper bound of section contents held at once (by disassembler
+   *         and read-ahead) during last runDisassembler
+   */
+  size_t getPeakSectionBytes() const { return peak_section_bytes; }
+
+  /**
+   * Functions found in cache are not decoded again (except of instructions
+   * that depends on their address)
+   * @param cache shared cache, nullptr disables caching
+   */
+  void setFunctionCache(std::shared_ptr<llvm::FunctionCache> cache) {
+    function_cache = cache;
+  }
+
+  /**
+   * Functions decoded by runDisassembler (use it for re-analysis of
+   * a newer build)
+   * @return records of functions and cache they are stored in
+   */
+  befa::Analysis getAnalysis() const {
+    return befa::Analysis{function_records, function_cache};
+  }
+
+  /**
+   * Runs disassembler, functions that hasn't changed since previous
+   * analysis are taken from its cache (only instructions referencing
+   * addresses are decoded again)
+   *
+   * To reuse lifted instructions too, pass the same cache into
+   * InstructionMapper::set_function_cache.
+   *
+   * @param previous analysis of older build of this file
+   * @return which functions has changed, and where the others are now
+   */
+  befa::AnalysisDiff runIncremental(const befa::Analysis &previous);
+
   /**
    * Feed this into getArgs, so it will know where (ie. call) want's to jump
    *
@@ -204,6 +287,31 @@ class ExecutableFile
    */
   bb_t::vector::shared basic_block_buffer;
 
+  /**
+   * Bytes of section contents that may be read ahead of disassembler
+   */
+  size_t prefetch_budget = befa::SectionPrefetcher::default_budget;
+
+  /**
+   * Bytes of section contents kept in memory (0 is unlimited)
+   */
+  size_t memory_budget = 0;
+
+  /**
+   * @see getPeakSectionBytes
+   */
+  size_t peak_section_bytes = 0;
+
+  /**
+   * Cache of decoded functions (may be shared between files)
+   */
+  std::shared_ptr<llvm::FunctionCache> function_cache;
+
+  /**
+   * Functions decoded by last run of disassembler
+   */
+  std::vector<befa::FunctionRecord> function_records;
+
   /**
    * If this instance has valid file descriptor
    */
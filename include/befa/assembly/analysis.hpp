@@ -0,0 +1,111 @@
+//
+// Created by miro on 10/18/26.
+//
+
+#ifndef BEFA_ANALYSIS_HPP
+#define BEFA_ANALYSIS_HPP
+
+#include <bfd.h>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace llvm {
+/**
+ * defined in @see befa/llvm/function_cache.hpp
+ */
+struct FunctionCache;
+}
+
+namespace befa {
+
+/**
+ * Function as it was found by disassembler
+ */
+struct FunctionRecord {
+  std::string name;
+  bfd_vma address;
+  bfd_vma size;
+
+  /** @see Symbol::getContentHash */
+  uint64_t hash;
+
+  bool operator==(const FunctionRecord &rhs) const {
+    return name == rhs.name && address == rhs.address
+        && size == rhs.size && hash == rhs.hash;
+  }
+};
+
+/**
+ * Result of analysis, that can be used for re-analysis of newer build
+ * of the same binary
+ *
+ * Functions are stored in cache, records tell where they were.
+ */
+struct Analysis {
+  /** Functions in order of decoding */
+  std::vector<FunctionRecord> functions;
+
+  /** Decoded (and lifted) functions, can be shared */
+  std::shared_ptr<llvm::FunctionCache> cache;
+
+  /**
+   * Stores records into file (use FunctionCache directory to keep decoded
+   * functions too)
+   * @raises std::runtime_error
+   */
+  void save(const std::string &path) const;
+
+  /**
+   * Loads records stored by save
+   * @param cache where functions of loaded analysis are
+   * @raises std::runtime_error
+   */
+  static Analysis load(
+      const std::string &path,
+      std::shared_ptr<llvm::FunctionCache> cache
+  );
+};
+
+/**
+ * Difference of two analyses, functions are matched by name
+ * and by content hash
+ */
+struct AnalysisDiff {
+  /** Same name and same contents (records of newer analysis) */
+  std::vector<FunctionRecord> unchanged;
+
+  /** Same name, different contents (records of newer analysis) */
+  std::vector<FunctionRecord> changed;
+
+  /** Only in newer analysis */
+  std::vector<FunctionRecord> added;
+
+  /** Only in older analysis */
+  std::vector<FunctionRecord> removed;
+
+  /**
+   * Matches functions of two analyses
+   */
+  AnalysisDiff(
+      const Analysis &previous,
+      const Analysis &current
+  );
+
+  /**
+   * Translates address from previous analysis into the current one
+   * @param address anywhere inside of unchanged function
+   * @return new address or -1 if function has changed or has been removed
+   */
+  bfd_vma remap(bfd_vma address) const;
+
+ private:
+  /** previous address -> (previous, current) record of unchanged function */
+  std::map<
+      bfd_vma, std::pair<FunctionRecord, FunctionRecord>
+  > moved;
+};
+}  // namespace befa
+
+#endif //BEFA_ANALYSIS_HPP
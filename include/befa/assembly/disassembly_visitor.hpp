@@ -0,0 +1,54 @@
+//
+// Created by miro on 10/18/26.
+//
+
+#ifndef BEFA_DISASSEMBLY_VISITOR_HPP
+#define BEFA_DISASSEMBLY_VISITOR_HPP
+
+namespace befa {
+
+/**
+ * Receives structure of disassembly as it's being decoded
+ *
+ * Events are nested: section contains symbols, symbol contains basic
+ * blocks and basic block contains instructions. Every begin has its end.
+ * Parameters are valid only for time of the call (keep shared_ptr from
+ * getParent() of instruction to hold them longer).
+ *
+ * Default implementation does nothing, override what you need.
+ */
+template<
+    typename                  SectionT,
+    typename                  SymbolT,
+    typename                  BasicBlockT,
+    typename                  InstructionT
+>
+struct DisassemblyVisitor {
+  virtual ~DisassemblyVisitor() = default;
+
+  // ~~~~~ Section
+  virtual void sectionBegin(const SectionT &) {}
+
+  virtual void sectionEnd(const SectionT &) {}
+  // ~~~~~ Section
+
+  // ~~~~~ Symbol
+  virtual void symbolBegin(const SymbolT &) {}
+
+  virtual void symbolEnd(const SymbolT &) {}
+  // ~~~~~ Symbol
+
+  // ~~~~~ Basic block
+  virtual void blockBegin(const BasicBlockT &) {}
+
+  virtual void blockEnd(const BasicBlockT &) {}
+  // ~~~~~ Basic block
+
+  /**
+   * The same instruction that is passed into disassembly()
+   */
+  virtual void instruction(const InstructionT &) {}
+};
+}  // namespace befa
+
+#endif //BEFA_DISASSEMBLY_VISITOR_HPP
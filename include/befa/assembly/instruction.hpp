@@ -5,13 +5,17 @@
 #ifndef BEFA_INSTRUCTION_HPP
 #define BEFA_INSTRUCTION_HPP
 
+#include <cctype>
 #include <memory>
+#include <vector>
 #include <pcrecpp.h>
 #include <rxcpp/rx-observable.hpp>
 
 #include "../utils/algorithms.hpp"
 #include "../utils/byte_array_view.hpp"
 #include "instruction_parser.hpp"
+#include "mnemonic.hpp"
+#include "tokenizer.hpp"
 
 namespace befa {
 static const ::pcrecpp::RE parse_regex = std::string(
@@ -26,7 +30,7 @@ static const ::pcrecpp::RE parse_regex = std::string(
 );
 
 namespace details {
-inline auto split(
+inline std::vector<piece_slice> split(
     const std::string &str,
     const pcrecpp::RE &parse_regex
 );
@@ -45,32 +49,47 @@ struct Instruction
   // Dummy instruction
   Instruction()  =            default;
 
+  /**
+   * @param owner keeps memory of bytes and parent alive, if they are
+   *        released by disassembler before instruction (streaming mode)
+   */
   Instruction(
       bytes_t                 bytes    ,
       typename
       bb_t::ptr::weak         parent   ,
       std::string             decoded  ,
-      bfd_vma                 address
+      bfd_vma                 address  ,
+      std::shared_ptr<const void> owner = nullptr
   ) : bytes                  (bytes   ),
       parent                 (parent  ),
+      owner                  (std::move(owner)),
       decoded                (decoded ),
-      address                (address ) {}
+      address                (address ),
+      mnemonic               (fetch_mnemonic(this->decoded)) {}
 
   // ~~~~~~~~~~~~~~ Conversions ~~~~~~~~~~~~~~
   Instruction(
       self&&              rhs
   ) : bytes    (std::move(rhs.bytes  )),
       parent   (std::move(rhs.parent )),
+      owner    (std::move(rhs.owner  )),
       decoded  (std::move(rhs.decoded)),
-      address  (std::move(rhs.address)) {}
+      address  (std::move(rhs.address)),
+      mnemonic (          rhs.mnemonic),
+      slices   (std::move(rhs.slices )),
+      is_split (          rhs.is_split) {}
 
   Instruction&                operator=(
       self&&              rhs
   ) {
     bytes     = std::move(rhs.bytes  );
     parent    = std::move(rhs.parent );
+    owner     = std::move(rhs.owner  );
     decoded   = std::move(rhs.decoded);
     address   = std::move(rhs.address);
+    mnemonic  =           rhs.mnemonic;
+    slices    = std::move(rhs.slices );
+    is_split  =           rhs.is_split;
     return                   *this    ;
   }
 
@@ -78,16 +97,24 @@ struct Instruction
       const self&         rhs
   ) : bytes              (rhs.bytes  ),
       parent             (rhs.parent ),
+      owner              (rhs.owner  ),
       decoded            (rhs.decoded),
-      address            (rhs.address) {}
+      address            (rhs.address),
+      mnemonic           (rhs.mnemonic),
+      slices             (rhs.slices ),
+      is_split           (rhs.is_split) {}
 
   Instruction&               operator=(
       const self&         rhs
   ) {
     bytes               = rhs.bytes  ;
     parent              = rhs.parent ;
+    owner               = rhs.owner  ;
     decoded             = rhs.decoded;
     address             = rhs.address;
+    mnemonic            = rhs.mnemonic;
+    slices              = rhs.slices ;
+    is_split            = rhs.is_split;
     return                   *this   ;
   }
   // ~~~~~~~~~~~~~~ Conversions ~~~~~~~~~~~~~~
@@ -100,11 +127,31 @@ struct Instruction
   bfd_vma            getAddress() const { return address; }
 
   piece_t::rx::obs   parse()      const   override {
-    return details::split(getDecoded(), parse_regex);
+    std::vector<std::string> pieces;
+    for (size_t i = 0; i < pieceCount(); ++i)
+      pieces.emplace_back(piece(i));
+    return rxcpp::sources::iterate(std::move(pieces));
   }
 
+  /**
+   * @return mnemonic (mov, call, ...), valid as long as this instruction
+   */
+  std::string_view   getMnemonic() const {
+    return pieceCount() ? piece(0) : std::string_view();
+  }
+
+  /**
+   * @return id of mnemonic (assigned when instruction is created)
+   */
+  Mnemonic           getMnemonicId() const { return mnemonic; }
+
   typename
   bb_t::ptr::shared  getParent()  const { return ptr_lock(parent); }
+
+  /**
+   * @return false for instruction out of disassembly (without basic block)
+   */
+  bool               hasParent()  const { return !parent.expired(); }
   // ~~~~~~~~~~~~~~ Getters ~~~~~~~~~~~~~~
 
   // ~~~~~~~~~~~~~~ Operators ~~~~~~~~~~~~~~
@@ -117,7 +164,58 @@ struct Instruction
   }
   // ~~~~~~~~~~~~~~ Operators ~~~~~~~~~~~~~~
 
+ protected:
+  // ~~~~~~~~~~~~~~ Pieces ~~~~~~~~~~~~~~
+  size_t             pieceCount() const   override {
+    if (!is_split) {
+      tokenize(decoded, slices);
+      // mnemonic is the first piece (@see skip_prefixes)
+      size_t prefixes = 0;
+      while (prefixes + 1 < slices.size() && is_prefix(
+          std::string_view(decoded).substr(
+              slices[prefixes].offset, slices[prefixes].length
+          )))
+        ++prefixes;
+      slices.erase(slices.begin(), slices.begin() + prefixes);
+      is_split = true;
+    }
+    return slices.size();
+  }
+
+  std::string_view   piece(
+      size_t              index
+  )                               const   override {
+    pieceCount();
+    return std::string_view(decoded).substr(
+        slices[index].offset, slices[index].length
+    );
+  }
+
+  std::string_view   operandsText() const   override {
+    if (pieceCount() < 2)
+      return {};
+    size_t begin = slices[1].offset;
+    return std::string_view(decoded).substr(
+        begin, slices.back().offset + slices.back().length - begin
+    );
+  }
+  // ~~~~~~~~~~~~~~ Pieces ~~~~~~~~~~~~~~
+
  private:
+  /**
+   * @return id of the first word of decoded instruction after prefixes
+   */
+  static Mnemonic    fetch_mnemonic(
+      const std::string&  decoded
+  ) {
+    auto mnemonic = skip_prefixes(decoded);
+    size_t length = 0;
+    while (length < mnemonic.size()
+        && std::isalnum((unsigned char) mnemonic[length]))
+      ++length;
+    return find_mnemonic(mnemonic.substr(0, length));
+  }
+
   // ~~~~~~~~~~~~~~ Fields ~~~~~~~~~~~~~~
 
   /**
@@ -130,6 +228,11 @@ struct Instruction
    */
   typename bb_t::ptr::weak    parent;
 
+  /**
+   * Owner of bytes and parent (nullptr if they live as long as file)
+   */
+  std::shared_ptr<const void> owner;
+
   /**
    * Decoded data in human readable representation (intel-syntax assembly language)
    */
@@ -139,30 +242,47 @@ struct Instruction
    * Address relative to file
    */
   bfd_vma                     address;
+
+  /**
+   * Id of mnemonic, @see befa/assembly/mnemonic.hpp
+   */
+  Mnemonic                    mnemonic = Mnemonic::unknown;
+
+  /**
+   * Pieces of decoded, split lazily (once) by tokenize
+   */
+  mutable std::vector<
+      details::piece_slice
+  >                           slices;
+  mutable bool                is_split = false;
   // ~~~~~~~~~~~~~~ Fields ~~~~~~~~~~~~~~
 };
 
 namespace details {
 /**
- * Splits into groups
+ * Splits into groups (reference for tokenize, which is used instead)
  *
  * @param str to be split by regular expression
  * @param parse_regex is pcree
- * @return observable of parsed pieces
+ * @return positions of parsed pieces in str
  */
-auto split(
+std::vector<piece_slice> split(
     const std::string& str,
     const pcrecpp::RE& parse_regex
 ) {
-  return rxcpp::sources::create<std::string>(
-      [&] (rxcpp::subscriber<std::string> s) {
-        string temp;
-        pcrecpp::StringPiece input(str);
-        while (parse_regex.FindAndConsume(&input, &temp))
-          s.on_next(temp);
-        s.on_completed();
-      }
-  );
+  std::vector<piece_slice> slices;
+  pcrecpp::StringPiece input(str);
+  pcrecpp::StringPiece temp;
+  while (parse_regex.FindAndConsume(&input, &temp)) {
+    // group that did not participate (# 0x...) is empty piece
+    if (temp.data() == nullptr)
+      slices.push_back({0, 0});
+    else
+      slices.push_back({
+          (uint32_t) (temp.data() - str.data()), (uint32_t) temp.size()
+      });
+  }
+  return slices;
 }
 }  // namespace details
 }  // namespace befa
@@ -5,12 +5,16 @@
 #ifndef BEFA_INSTRUCTION_PARSER_HPP
 #define BEFA_INSTRUCTION_PARSER_HPP
 
+#include <typeindex>
+#include <unordered_map>
 #include <unordered_set>
 #include <map>
 #include <string>
+#include <string_view>
 #include <regex>
 #include <rxcpp/rx.hpp>
 
+#include "../utils/arena.hpp"
 #include "../utils/types.hpp"
 #include "../utils/assert.hpp"
 #include "../utils/visitor.hpp"
@@ -18,6 +22,13 @@
 #include "section.hpp"
 #include "symbol.hpp"
 
+namespace befa {
+/**
+ * defined in @see befa/assembly/parse_memo.hpp
+ */
+struct ParseMemo;
+}
+
 namespace symbol_table {
 /**
  * Symbol type enumerators
@@ -356,7 +367,13 @@ struct Symbol
   /**
    * @return name of this symbol (like eax or ebp)
    */
-  const std::string &getName() const { return name; }
+  const std::string &getName() const {
+    if (!has_name) {
+      name = renderName();
+      has_name = true;
+    }
+    return name;
+  }
 
   bfd_vma getAddress() const { return address; }
 
@@ -364,9 +381,26 @@ struct Symbol
     base.visit(this);
   }
 
+ protected:
+  struct lazy_name_t {};
+
+  /**
+   * Name is rendered on first getName() (@see renderName)
+   */
+  Symbol(
+      lazy_name_t,
+      bfd_vma address = (bfd_vma) -1
+  ) : address(address), has_name(false) {}
+
+  /**
+   * @return name of symbol created with lazy_name_t
+   */
+  virtual std::string renderName() const { return {}; }
+
  private:
-  std::string name;
+  mutable std::string name;
   bfd_vma address;
+  mutable bool has_name = true;
 };
 
 
@@ -510,6 +544,8 @@ auto cast_symbol_to_visitable(BaseT &&obj) {
 
 /**
  * Result of some kind of operation
+ *
+ * Name is built from names of operands on first getName().
  */
 struct Temporary
     : virtual public VisitableBase,
@@ -517,11 +553,11 @@ struct Temporary
   using symbol_ptr = std::shared_ptr<VisitableBase>;
 
   Temporary(symbol_ptr lhs, std::string op, symbol_ptr rhs)
-      : Symbol(fetchName(rhs, op, lhs)),
+      : Symbol(lazy_name_t()),
         lhs(lhs), op(op), rhs(rhs) {}
 
   Temporary(std::string op, symbol_ptr rhs)
-      : Symbol(fetchName(rhs, op)),
+      : Symbol(lazy_name_t()),
         lhs(nullptr), op(op), rhs(rhs) {}
 
   /**
@@ -529,7 +565,7 @@ struct Temporary
    * @param rhs
    */
   Temporary(symbol_ptr rhs)
-      : Symbol(fetchName(rhs)),
+      : Symbol(lazy_name_t()),
         lhs(nullptr), op(""), rhs(rhs) {}
 
   void accept(VisitorBase &base) const override {
@@ -555,6 +591,10 @@ struct Temporary
       : Symbol(""),
         lhs(nullptr), op(""), rhs(nullptr) {}
 
+  std::string renderName() const override {
+    return fetchName(rhs, op, lhs);
+  }
+
   /**
    * So we could add <TYPE> to variables
    */
@@ -588,18 +628,18 @@ struct SizedTemporary
       const symbol_ptr &lhs,
       const std::string &op,
       const symbol_ptr &rhs
-  ) : Symbol(fetchName(rhs, op, lhs))
+  ) : Symbol(lazy_name_t())
     , Temporary(lhs, op, rhs) {}
 
   SizedTemporary(
       const std::string &op,
       const symbol_ptr &rhs
-  ) : Symbol(fetchName(rhs, op))
+  ) : Symbol(lazy_name_t())
     , Temporary(op, rhs) {}
 
   SizedTemporary(
       const symbol_ptr &rhs
-  ) : Symbol(fetchName(rhs))
+  ) : Symbol(lazy_name_t())
     , Temporary(rhs) {}
 
   SizedTemporary(
@@ -613,7 +653,7 @@ struct SizedTemporary
  protected:
   std::string fetchName(
       const symbol_ptr &rhs,
-      const std::string &op = nullptr,
+      const std::string &op = "",
       const symbol_ptr &lhs = nullptr
   ) const override {
     return "((" + std::string(size_trait::name) + ")"
@@ -688,24 +728,214 @@ struct Function
 };
 
 /**
- * This is most probably a number
+ * This is most probably a number (hexadecimal, as objdump prints it)
+ *
+ * Number is parsed once, name is rendered on first use and keeps format
+ * of the original text (0x prefix, leading zeros and case).
  */
 struct Immidiate
     : virtual public VisitableBase
     , public Symbol {
-  Immidiate(std::string value)
-      : Symbol(value), value(value) {}
+  /**
+   * @param value is text of number (0x1f, 00401000, ...), anything else
+   *        is kept as it is and isNumeric() is false
+   */
+  Immidiate(std::string_view value);
+
+  /**
+   * @param value is text of number that has been already scanned
+   * @param number is value of the text
+   */
+  Immidiate(std::string_view value, uint64_t number);
+
+  /**
+   * @param number is rendered as 0x<hex>
+   * @param width in bits (8, 16, 32 or 64)
+   */
+  Immidiate(uint64_t number, uint8_t width);
+
+  /**
+   * @return text of this immidiate
+   */
+  const std::string &getValue() const { return getName(); }
+
+  /**
+   * @return false if text is not a number or it does not fit 64 bits
+   */
+  bool isNumeric() const { return numeric; }
+
+  uint64_t getUnsigned() const { return number; }
+
+  /**
+   * @return number sign-extended from its width
+   */
+  int64_t getSigned() const;
 
   /**
-   * @return value of this immidiate
+   * @return width in bits (8, 16, 32 or 64) given by number of digits
    */
-  const std::string &getValue() const { return value; }
+  uint8_t getWidth() const { return width; }
 
   void accept(VisitorBase &base) const override {
     base.visit(this);
   }
+
+ protected:
+  std::string renderName() const override;
+
  private:
-  std::string value;
+  /**
+   * Remembers format of value, or keeps value as text when it can't
+   * be reproduced
+   */
+  void format(std::string_view value);
+
+  uint64_t number = 0;
+  uint8_t width = 64;
+  uint8_t digits = 0;
+  bool prefixed = false;
+  bool upper = false;
+  bool numeric = false;
+  /** only for non-numeric values */
+  std::string text;
+};
+
+/**
+ * Creates operand nodes, structurally equal nodes are created only once
+ * (hash-consing), so equal pointers mean equal expressions
+ *
+ * Nodes are compared by type and text (leaves) or by type, operator and
+ * pointers to children (children are already unique). Created nodes must
+ * not be modified. Not thread safe.
+ */
+struct ExpressionPool {
+  using symbol_ptr = std::shared_ptr<VisitableBase>;
+  using arena_ptr = std::shared_ptr<befa::Arena>;
+  using memo_ptr = std::shared_ptr<befa::ParseMemo>;
+
+  /**
+   * @param arena if set, owns created nodes (returned pointers share
+   *        ownership of the whole arena, nested nodes don't own each other)
+   * @param memo if set, operands of instructions are taken from it
+   *        (and they are created in its pool)
+   */
+  explicit ExpressionPool(
+      arena_ptr arena = nullptr,
+      memo_ptr memo = nullptr
+  ) : arena(std::move(arena)), memo(std::move(memo)) {}
+
+  /**
+   * @tparam T is Symbol or Immidiate
+   * @param args are passed to constructor (they must follow from text)
+   * @return node T(text, args...)
+   */
+  template<
+      typename T,
+      typename... ArgsT
+  >
+  symbol_ptr leaf(std::string_view text, ArgsT &&...args) {
+    return intern({typeid(T), std::string(text), nullptr, nullptr}, [&](
+        const std::string &text
+    ) { return make<T>(text, std::forward<ArgsT>(args)...); });
+  }
+
+  /**
+   * @tparam T is (Sized)Temporary
+   * @return node T(op, rhs)
+   */
+  template<typename T>
+  symbol_ptr unary(std::string_view op, const symbol_ptr &rhs) {
+    return intern({typeid(T), std::string(op), nullptr, rhs.get()}, [&](
+        const std::string &op
+    ) { return make<T>(op, child(rhs)); });
+  }
+
+  /**
+   * @tparam T is (Sized)Temporary
+   * @return node T(lhs, op, rhs)
+   */
+  template<typename T>
+  symbol_ptr binary(
+      const symbol_ptr &lhs,
+      std::string_view op,
+      const symbol_ptr &rhs
+  ) {
+    return intern({typeid(T), std::string(op), lhs.get(), rhs.get()}, [&](
+        const std::string &op
+    ) { return make<T>(child(lhs), op, child(rhs)); });
+  }
+
+  /**
+   * @return number of distinct nodes
+   */
+  size_t size() const { return nodes.size(); }
+
+  const arena_ptr &getArena() const { return arena; }
+
+  const memo_ptr &getMemo() const { return memo; }
+
+ private:
+  struct key_t {
+    std::type_index kind;
+    std::string text;
+    const VisitableBase *lhs;
+    const VisitableBase *rhs;
+
+    bool operator==(const key_t &other) const {
+      return kind == other.kind && lhs == other.lhs && rhs == other.rhs
+          && text == other.text;
+    }
+  };
+
+  struct key_hash {
+    size_t operator()(const key_t &key) const {
+      size_t hash = key.kind.hash_code();
+      for (size_t part : {
+          std::hash<std::string>()(key.text),
+          std::hash<const void *>()(key.lhs),
+          std::hash<const void *>()(key.rhs)
+      })
+        hash ^= part + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+      return hash;
+    }
+  };
+
+  template<typename CreateT>
+  symbol_ptr intern(key_t key, CreateT create) {
+    auto ite = nodes.find(key);
+    if (ite != nodes.end())
+      return ite->second;
+    auto node = create(key.text);
+    nodes.emplace(std::move(key), node);
+    return node;
+  }
+
+  /**
+   * Creates node in arena or on heap if there is no arena
+   */
+  template<
+      typename T,
+      typename... ArgsT
+  >
+  symbol_ptr make(ArgsT &&...args) const {
+    if (arena)
+      return arena->handle<T>(std::forward<ArgsT>(args)...);
+    return std::make_shared<T>(std::forward<ArgsT>(args)...);
+  }
+
+  /**
+   * Nodes of one arena must not own each other (arena would own itself),
+   * so child from the same arena is referenced by non-owning pointer
+   */
+  symbol_ptr child(const symbol_ptr &node) const {
+    if (arena && !node.owner_before(arena) && !arena.owner_before(node))
+      return symbol_ptr(symbol_ptr(), node.get());
+    return node;
+  }
+
+  arena_ptr arena;
+  memo_ptr memo;
+  std::unordered_map<key_t, symbol_ptr, key_hash> nodes;
 };
 }  // namespace symbol_table
 
@@ -717,14 +947,55 @@ struct instruction_parser {
   using sym_map_t = types::traits::container<
       typename sym_t::map<address_t::type>::shared
   >;
+  using arena_t = types::traits::container<befa::Arena>;
+  using pool_t = types::traits::container<symbol_table::ExpressionPool>;
+
+  /**
+   * Read-only view of functions by address, that can be layered over
+   * base map (base is searched first), so maps of function-local symbols
+   * don't have to copy the shared one
+   */
+  struct AddressLookup {
+    AddressLookup() : symbols(nullptr), base(nullptr) {}
+
+    AddressLookup(
+        sym_map_t::c::ref symbols,
+        const sym_map_t::type *base = nullptr
+    ) : symbols(&symbols), base(base) {}
+
+    /**
+     * @return function at address or nullptr
+     */
+    sym_t::ptr::shared find(bfd_vma address) const;
+
+    size_t count(bfd_vma address) const { return find(address) ? 1 : 0; }
+
+   private:
+    const sym_map_t::type *symbols;
+    const sym_map_t::type *base;
+  };
+  using lookup_t = types::traits::container<AddressLookup>;
 
   /**
    * Arguments are Immidiate, Expressions, Registers, ...
    *
+   * @param functions are used to resolve addresses
+   * @param arena if set, owns newly created nodes (returned pointers share
+   *        ownership of the whole arena, nested nodes don't own each other)
    * @return vector of parameters
    */
   sym_t::rx::shared_obs getArgs(
-      sym_map_t::c::ref functions = {}
+      lookup_t::c::ref functions = {},
+      const arena_t::ptr::shared &arena = nullptr
+  ) const throw(std::runtime_error);
+
+  /**
+   * Same as above, but equal operands of all instructions parsed with
+   * the same pool are the same node
+   */
+  sym_t::rx::shared_obs getArgs(
+      lookup_t::c::ref functions,
+      const pool_t::ptr::shared &pool
   ) const throw(std::runtime_error);
 
   /**
@@ -741,6 +1012,9 @@ struct instruction_parser {
    * @return name of this instruction
    */
   std::string getName() const {
+    if (pieceCount() != no_pieces)
+      return pieceCount() ? std::string(piece(0)) : std::string();
+
     std::string name;
     parse()
         .first()
@@ -750,28 +1024,58 @@ struct instruction_parser {
     return name;
   }
 
- private:
+ protected:
+  static constexpr size_t no_pieces = (size_t) -1;
 
+  /**
+   * Implementations that keep pieces (mnemonic and operands) of instruction
+   * override this and piece(), so parse() does not have to be called
+   *
+   * @return number of pieces or no_pieces
+   */
+  virtual size_t pieceCount() const { return no_pieces; }
+
+  /**
+   * @param index of piece, 0 is mnemonic
+   * @return piece (valid as long as this instruction)
+   */
+  virtual std::string_view piece(size_t) const { return {}; }
+
+  /**
+   * @return text that contains all pieces after mnemonic (key of
+   *         ParseMemo), empty if operands should not be memoized
+   */
+  virtual std::string_view operandsText() const { return {}; }
+
+ private:
   /**
    * This just parses argument, then returns newly created Symbol
    *
+   * Hand-written scanner, checks are tried in this order: function address,
+   * register, number, dereference, multiplication and add/subtraction
+   * (binary operators are split at their last occurrence).
+   *
    * @param expr
    * @return Symbol as VisitableBase object
    */
   sym_t::ptr::shared handle_expression(
-      piece_t::type expr,
-      sym_map_t::c::ref functions
+      std::string_view expr,
+      lookup_t::c::ref functions,
+      pool_t::ref pool
   ) const throw(std::runtime_error);
 
   /**
    * creates immidiate variable
    *
    * @param value immidiate varaible's value
+   * @param number is value scanned from text
    * @return Immidiate object
    */
   sym_t::ptr::shared create_imm(
-      piece_t::type value,
-      sym_map_t::c::ref functions
+      std::string_view value,
+      bfd_vma number,
+      lookup_t::c::ref functions,
+      pool_t::ref pool
   ) const throw();
 
   /**
@@ -783,10 +1087,11 @@ struct instruction_parser {
    * @return newly created Temporary object with parsed expression
    */
   sym_t::ptr::shared create_operation(
-      piece_t::type lhs,
-      piece_t::type op,
-      piece_t::type rhs,
-      sym_map_t::c::ref functions
+      std::string_view lhs,
+      char op,
+      std::string_view rhs,
+      lookup_t::c::ref functions,
+      pool_t::ref pool
   ) const throw(std::runtime_error);
 
   /**
@@ -797,9 +1102,10 @@ struct instruction_parser {
    * @return newly created SizedTemporary
    */
   sym_t::ptr::shared create_dereference(
-      piece_t::type size,
-      piece_t::type expr,
-      sym_map_t::c::ref functions
+      std::string_view size,
+      std::string_view expr,
+      lookup_t::c::ref functions,
+      pool_t::ref pool
   ) const throw(std::runtime_error);
 };
 
@@ -0,0 +1,340 @@
+//
+// Created by miro on 10/18/26.
+//
+
+#ifndef BEFA_MNEMONIC_HPP
+#define BEFA_MNEMONIC_HPP
+
+#include <cstdint>
+#include <string_view>
+
+#include "../utils/perfect_hash.hpp"
+
+/**
+ * List of known mnemonics: X(mnemonic, categories, condition)
+ *
+ *  mnemonic   is prefixed by '_' (and, or, not are reserved in c++)
+ *  categories are MnemonicInfo::category_e flags
+ *  condition  is tested condition code (jcc, cmovcc, setcc)
+ */
+#define ASM_MNEMONIC_TABLE(X) \
+  /* conditional jumps */ \
+  X(_ja,        JCC,   a    ) \
+  X(_jae,       JCC,   ae   ) \
+  X(_jb,        JCC,   b    ) \
+  X(_jbe,       JCC,   be   ) \
+  X(_jc,        JCC,   b    ) \
+  X(_jcxz,      JCC,   cxz  ) \
+  X(_je,        JCC,   e    ) \
+  X(_jecxz,     JCC,   ecxz ) \
+  X(_jrcxz,     JCC,   rcxz ) \
+  X(_jg,        JCC,   g    ) \
+  X(_jge,       JCC,   ge   ) \
+  X(_jl,        JCC,   l    ) \
+  X(_jle,       JCC,   le   ) \
+  X(_jna,       JCC,   be   ) \
+  X(_jnae,      JCC,   b    ) \
+  X(_jnb,       JCC,   ae   ) \
+  X(_jnbe,      JCC,   a    ) \
+  X(_jnc,       JCC,   ae   ) \
+  X(_jne,       JCC,   ne   ) \
+  X(_jng,       JCC,   le   ) \
+  X(_jnge,      JCC,   l    ) \
+  X(_jnl,       JCC,   ge   ) \
+  X(_jnle,      JCC,   g    ) \
+  X(_jno,       JCC,   no   ) \
+  X(_jnp,       JCC,   np   ) \
+  X(_jns,       JCC,   ns   ) \
+  X(_jnz,       JCC,   ne   ) \
+  X(_jo,        JCC,   o    ) \
+  X(_jp,        JCC,   p    ) \
+  X(_jpe,       JCC,   p    ) \
+  X(_jpo,       JCC,   np   ) \
+  X(_js,        JCC,   s    ) \
+  X(_jz,        JCC,   e    ) \
+  /* control flow */ \
+  X(_jmp,       JMP,   none ) \
+  X(_call,      CALL,  none ) \
+  X(_ret,       RET,   none ) \
+  X(_leave,     NONE,  none ) \
+  X(_hlt,       NONE,  none ) \
+  X(_syscall,   NONE,  none ) \
+  X(_int3,      NONE,  none ) \
+  X(_ud2,       NONE,  none ) \
+  X(_nop,       NONE,  none ) \
+  X(_endbr64,   NONE,  none ) \
+  /* data transfer */ \
+  X(_mov,       NONE,  none ) \
+  X(_movabs,    NONE,  none ) \
+  X(_movzx,     NONE,  none ) \
+  X(_movsx,     NONE,  none ) \
+  X(_movsxd,    NONE,  none ) \
+  X(_lea,       NONE,  none ) \
+  X(_push,      NONE,  none ) \
+  X(_pop,       NONE,  none ) \
+  X(_xchg,      NONE,  none ) \
+  X(_cmpxchg,   NONE,  none ) \
+  X(_bswap,     NONE,  none ) \
+  X(_cbw,       NONE,  none ) \
+  X(_cwde,      NONE,  none ) \
+  X(_cdqe,      NONE,  none ) \
+  X(_cwd,       NONE,  none ) \
+  X(_cdq,       NONE,  none ) \
+  X(_cqo,       NONE,  none ) \
+  X(_movs,      NONE,  none ) \
+  X(_stos,      NONE,  none ) \
+  X(_lods,      NONE,  none ) \
+  X(_scas,      NONE,  none ) \
+  X(_cmps,      NONE,  none ) \
+  /* arithmetic and logic */ \
+  X(_add,       NONE,  none ) \
+  X(_adc,       NONE,  none ) \
+  X(_sub,       NONE,  none ) \
+  X(_sbb,       NONE,  none ) \
+  X(_imul,      NONE,  none ) \
+  X(_mul,       NONE,  none ) \
+  X(_div,       NONE,  none ) \
+  X(_idiv,      NONE,  none ) \
+  X(_inc,       NONE,  none ) \
+  X(_dec,       NONE,  none ) \
+  X(_neg,       NONE,  none ) \
+  X(_cmp,       NONE,  none ) \
+  X(_test,      NONE,  none ) \
+  X(_and,       NONE,  none ) \
+  X(_or,        NONE,  none ) \
+  X(_xor,       NONE,  none ) \
+  X(_not,       NONE,  none ) \
+  X(_shl,       NONE,  none ) \
+  X(_shr,       NONE,  none ) \
+  X(_sar,       NONE,  none ) \
+  X(_sal,       NONE,  none ) \
+  X(_rol,       NONE,  none ) \
+  X(_ror,       NONE,  none ) \
+  X(_bt,        NONE,  none ) \
+  X(_bts,       NONE,  none ) \
+  X(_btr,       NONE,  none ) \
+  X(_cpuid,     NONE,  none ) \
+  X(_rdtsc,     NONE,  none ) \
+  /* conditional moves */ \
+  X(_cmova,     CMOV,  a    ) \
+  X(_cmovae,    CMOV,  ae   ) \
+  X(_cmovb,     CMOV,  b    ) \
+  X(_cmovbe,    CMOV,  be   ) \
+  X(_cmove,     CMOV,  e    ) \
+  X(_cmovne,    CMOV,  ne   ) \
+  X(_cmovg,     CMOV,  g    ) \
+  X(_cmovge,    CMOV,  ge   ) \
+  X(_cmovl,     CMOV,  l    ) \
+  X(_cmovle,    CMOV,  le   ) \
+  X(_cmovs,     CMOV,  s    ) \
+  X(_cmovns,    CMOV,  ns   ) \
+  /* conditional sets */ \
+  X(_seta,      SETCC, a    ) \
+  X(_setae,     SETCC, ae   ) \
+  X(_setb,      SETCC, b    ) \
+  X(_setbe,     SETCC, be   ) \
+  X(_sete,      SETCC, e    ) \
+  X(_setne,     SETCC, ne   ) \
+  X(_setg,      SETCC, g    ) \
+  X(_setge,     SETCC, ge   ) \
+  X(_setl,      SETCC, l    ) \
+  X(_setle,     SETCC, le   ) \
+  X(_sets,      SETCC, s    ) \
+  X(_setns,     SETCC, ns   ) \
+  X(_setp,      SETCC, p    ) \
+  X(_setnp,     SETCC, np   ) \
+  /* sse */ \
+  X(_movd,      NONE,  none ) \
+  X(_movq,      NONE,  none ) \
+  X(_movss,     NONE,  none ) \
+  X(_movsd,     NONE,  none ) \
+  X(_movaps,    NONE,  none ) \
+  X(_movups,    NONE,  none ) \
+  X(_movdqa,    NONE,  none ) \
+  X(_movdqu,    NONE,  none ) \
+  X(_pxor,      NONE,  none ) \
+  X(_xorps,     NONE,  none ) \
+  X(_xorpd,     NONE,  none ) \
+  X(_addss,     NONE,  none ) \
+  X(_addsd,     NONE,  none ) \
+  X(_subss,     NONE,  none ) \
+  X(_subsd,     NONE,  none ) \
+  X(_mulss,     NONE,  none ) \
+  X(_mulsd,     NONE,  none ) \
+  X(_divss,     NONE,  none ) \
+  X(_divsd,     NONE,  none ) \
+  X(_cvtsi2sd,  NONE,  none ) \
+  X(_cvtsi2ss,  NONE,  none ) \
+  X(_cvttsd2si, NONE,  none ) \
+  X(_cvttss2si, NONE,  none ) \
+  X(_ucomiss,   NONE,  none ) \
+  X(_ucomisd,   NONE,  none ) \
+  X(_comiss,    NONE,  none ) \
+  X(_comisd,    NONE,  none ) \
+  X(_pcmpeqb,   NONE,  none ) \
+  X(_pmovmskb,  NONE,  none ) \
+  X(_pshufd,    NONE,  none )
+
+namespace befa {
+
+/**
+ * Dense id of instruction mnemonic, unknown ones are Mnemonic::unknown
+ */
+enum class Mnemonic : uint8_t {
+#define MNEMONIC_ID(mnemonic, categories, condition) mnemonic,
+  ASM_MNEMONIC_TABLE(MNEMONIC_ID)
+#undef MNEMONIC_ID
+  unknown
+};
+
+constexpr size_t mnemonic_count = (size_t) Mnemonic::unknown;
+
+/**
+ * Condition codes (aliases like jz/je share one)
+ */
+enum class Condition : uint8_t {
+  none,
+  // overflow         no overflow
+  o,                  no,
+  // below            above or equal   (unsigned)
+  b,                  ae,
+  // equal            not equal
+  e,                  ne,
+  // below or equal   above            (unsigned)
+  be,                 a,
+  // sign             no sign
+  s,                  ns,
+  // parity           no parity
+  p,                  np,
+  // less             greater or equal (signed)
+  l,                  ge,
+  // less or equal    greater          (signed)
+  le,                 g,
+  // (e|r)cx is zero
+  cxz,                ecxz,            rcxz,
+};
+
+/**
+ * Static metadata of mnemonic
+ */
+struct MnemonicInfo {
+  enum category_e : uint8_t {
+    NONE  = 0,
+    JCC   = 1 << 0,
+    JMP   = 1 << 1,
+    CALL  = 1 << 2,
+    RET   = 1 << 3,
+    CMOV  = 1 << 4,
+    SETCC = 1 << 5,
+  };
+
+  std::string_view name;
+  uint8_t          categories;
+  Condition        condition;
+};
+
+constexpr MnemonicInfo mnemonic_info[mnemonic_count] = {
+#define MNEMONIC_INFO(mnemonic, categories, condition) \
+  {std::string_view(#mnemonic).substr(1), MnemonicInfo::categories, \
+   Condition::condition},
+  ASM_MNEMONIC_TABLE(MNEMONIC_INFO)
+#undef MNEMONIC_INFO
+};
+
+namespace details {
+constexpr std::string_view mnemonic_names[mnemonic_count] = {
+#define MNEMONIC_NAME(mnemonic, categories, condition) \
+  std::string_view(#mnemonic).substr(1),
+  ASM_MNEMONIC_TABLE(MNEMONIC_NAME)
+#undef MNEMONIC_NAME
+};
+
+constexpr PerfectHash<mnemonic_count, 4096> mnemonic_hash(mnemonic_names);
+
+constexpr uint8_t categories(Mnemonic mnemonic) noexcept {
+  return mnemonic < Mnemonic::unknown
+         ? mnemonic_info[(size_t) mnemonic].categories
+         : (uint8_t) MnemonicInfo::NONE;
+}
+}  // namespace details
+
+/**
+ * @param name is mnemonic as printed by disassembler (mov, jne, ...)
+ * @return id of mnemonic or Mnemonic::unknown
+ */
+constexpr Mnemonic find_mnemonic(std::string_view name) noexcept {
+  return (Mnemonic) details::mnemonic_hash.find(name);
+}
+
+// ~~~~~ Prefixes
+namespace details {
+constexpr std::string_view instruction_prefixes[] = {
+    "bnd", "notrack", "lock", "rep", "repz", "repnz", "repe", "repne",
+    "xacquire", "xrelease", "data16", "data32", "addr16", "addr32",
+    "cs", "ds", "es", "fs", "gs", "ss", "rex", "rex64",
+};
+}  // namespace details
+
+/**
+ * @param word is piece of decoded instruction
+ * @return true if disassembler prints word in front of mnemonic
+ *         (bnd jmp, notrack jmp, repz ret, lock cmpxchg, cs nop, rex.W ...)
+ */
+constexpr bool is_prefix(std::string_view word) noexcept {
+  if (word.substr(0, 4) == "rex.")
+    return true;
+  for (auto prefix : details::instruction_prefixes)
+    if (word == prefix)
+      return true;
+  return false;
+}
+
+/**
+ * @param decoded is instruction as printed by disassembler
+ * @return decoded without prefixes, so it starts with mnemonic
+ */
+constexpr std::string_view skip_prefixes(std::string_view decoded) noexcept {
+  while (true) {
+    size_t length = 0;
+    while (length < decoded.size() && decoded[length] != ' ')
+      ++length;
+    size_t next = length;
+    while (next < decoded.size() && decoded[next] == ' ')
+      ++next;
+    // prefix alone is its own mnemonic
+    if (next == decoded.size() || !is_prefix(decoded.substr(0, length)))
+      return decoded;
+    decoded.remove_prefix(next);
+  }
+}
+// ~~~~~ Prefixes
+
+// ~~~~~ Categories
+constexpr bool is_jcc(Mnemonic mnemonic) noexcept {
+  return details::categories(mnemonic) & MnemonicInfo::JCC;
+}
+
+constexpr bool is_jmp(Mnemonic mnemonic) noexcept {
+  return details::categories(mnemonic) & MnemonicInfo::JMP;
+}
+
+constexpr bool is_call(Mnemonic mnemonic) noexcept {
+  return details::categories(mnemonic) & MnemonicInfo::CALL;
+}
+
+constexpr bool is_ret(Mnemonic mnemonic) noexcept {
+  return details::categories(mnemonic) & MnemonicInfo::RET;
+}
+
+/**
+ * @return condition of jcc, cmovcc and setcc, otherwise Condition::none
+ */
+constexpr Condition condition(Mnemonic mnemonic) noexcept {
+  return mnemonic < Mnemonic::unknown
+         ? mnemonic_info[(size_t) mnemonic].condition
+         : Condition::none;
+}
+// ~~~~~ Categories
+}  // namespace befa
+
+#endif //BEFA_MNEMONIC_HPP
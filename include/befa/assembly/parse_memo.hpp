@@ -0,0 +1,119 @@
+//
+// Created by miro on 10/18/26.
+//
+
+#ifndef BEFA_PARSE_MEMO_HPP
+#define BEFA_PARSE_MEMO_HPP
+
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "instruction_parser.hpp"
+
+namespace befa {
+
+/**
+ * Bounded cache of parsed operands keyed by their decoded text
+ * (least recently used are evicted), shared by threads
+ *
+ * Operands that refer to a function are never stored. Stored operands
+ * remember numbers they contain and they are parsed again when some
+ * function lives at one of them, so result doesn't depend on functions
+ * map used for the first parse.
+ *
+ * Operands are parsed without holding the lock, each miss into its own
+ * pool, and their names are rendered before they are stored (nodes are
+ * shared between threads). If two threads parse the same text, operands
+ * of the first one are stored.
+ */
+struct ParseMemo {
+  using sym_t = instruction_parser::sym_t;
+  using lookup_t = instruction_parser::lookup_t;
+  using pool_t = instruction_parser::pool_t;
+
+  /** Default number of stored operand lists */
+  static constexpr size_t default_capacity = 4096;
+
+  /**
+   * @param capacity maximum of stored operand lists
+   */
+  explicit ParseMemo(size_t capacity = default_capacity);
+
+  // ~~~~~ Copy & Move semantics
+  ParseMemo(const ParseMemo &) = delete;
+  ParseMemo &operator=(const ParseMemo &) = delete;
+  // ~~~~~ Copy & Move semantics
+
+  /**
+   * @param text is decoded text of operands
+   * @param functions are used to resolve addresses
+   * @param parse creates operands from pool (called only on miss)
+   * @return operands of text
+   */
+  template<typename ParseT>
+  sym_t::vector::shared get(
+      std::string_view text,
+      lookup_t::c::ref functions,
+      ParseT parse
+  ) {
+    sym_t::vector::shared args;
+    {
+      std::lock_guard<std::mutex> guard(lock);
+      if (find(text, functions, args))
+        return args;
+    }
+    pool_t::type pool;
+    args = parse(pool);
+    insert(text, args);
+    return args;
+  }
+
+  size_t size() const;
+
+  size_t hits() const;
+
+  size_t misses() const;
+
+ private:
+  struct Entry {
+    std::string text;
+    sym_t::vector::shared args;
+    /** numbers that were looked up in functions */
+    std::vector<bfd_vma> numbers;
+  };
+
+  /**
+   * Moves found entry to the front (lock has to be held)
+   */
+  bool find(
+      std::string_view text,
+      lookup_t::c::ref functions,
+      sym_t::vector::shared &args
+  );
+
+  /**
+   * Stores operands, if they can be reused (takes lock)
+   */
+  void insert(
+      std::string_view text,
+      const sym_t::vector::shared &args
+  );
+
+  size_t capacity;
+  size_t hit_count = 0;
+  size_t miss_count = 0;
+
+  /** most recently used first */
+  std::list<Entry> entries;
+  /** keys are views of Entry::text */
+  std::unordered_map<std::string_view, std::list<Entry>::iterator> index;
+  mutable std::mutex lock;
+};
+}  // namespace befa
+
+#endif //BEFA_PARSE_MEMO_HPP
@@ -0,0 +1,132 @@
+//
+// Created by miro on 10/18/26.
+//
+
+#ifndef BEFA_PREFETCHER_HPP
+#define BEFA_PREFETCHER_HPP
+
+#include <bfd.h>
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace befa {
+
+/**
+ * Reads section contents ahead of the disassembler
+ *
+ * Sections are read by a background thread in the order they were
+ * scheduled (which is the order disassembler decodes them), so file I/O
+ * overlaps with decoding. Memory that has been read, but not yet taken,
+ * is bounded by budget.
+ *
+ * BFD is not thread safe, so worker reads the file with pread(2) through
+ * its own file descriptor. Sections whose contents are not stored verbatim
+ * in the file (compressed, archive members, in-memory, ...) are left for
+ * the caller and are loaded by bfd_get_section_contents on its thread.
+ */
+struct SectionPrefetcher {
+  using buffer_t = std::unique_ptr<uint8_t[]>;
+
+  /** Default read-ahead budget (64 MiB) */
+  static constexpr size_t default_budget = 64 << 20;
+
+  /**
+   * @param fd file descriptor of opened binary
+   * @param budget maximum of bytes read ahead, 0 disables read-ahead
+   * @param strict never exceeds budget (sections that doesn't fit are
+   *        read by take), otherwise one section is always read ahead
+   */
+  SectionPrefetcher(
+      bfd *fd, size_t budget = default_budget, bool strict = false
+  );
+
+  ~SectionPrefetcher();
+
+  // ~~~~~ Copy & Move semantics
+  SectionPrefetcher(const SectionPrefetcher &) = delete;
+  SectionPrefetcher &operator=(const SectionPrefetcher &) = delete;
+  // ~~~~~ Copy & Move semantics
+
+  /**
+   * Queues section for read-ahead (has to be called before start)
+   * @param section to be read, duplicates are ignored
+   */
+  void schedule(const asection *section);
+
+  /**
+   * Starts reading scheduled sections in background
+   */
+  void start();
+
+  /**
+   * Hands loaded contents of section to caller, blocks if section
+   * has not been read yet
+   *
+   * @param section which contents are requested
+   * @return buffer of bfd_section_size bytes
+   */
+  buffer_t take(const asection *section);
+
+  /**
+   * @return the most bytes that has been read ahead at once
+   */
+  size_t peak() const;
+
+ private:
+  struct slot {
+    bool done = false;
+    buffer_t buffer;
+  };
+
+  /**
+   * Worker thread body
+   */
+  void run();
+
+  /**
+   * @return true if contents of section can be read directly from file
+   */
+  bool readable(const asection *section) const;
+
+  /**
+   * Synchronous read through BFD (caller's thread only)
+   */
+  buffer_t load(const asection *section) const;
+
+  bfd *fd;
+
+  /** Own file descriptor, so worker doesn't touch BFD's one */
+  int file = -1;
+
+  size_t budget;
+
+  bool strict;
+
+  /** Bytes that has been read, but not taken yet */
+  size_t in_flight = 0;
+
+  /** Maximum of in_flight */
+  size_t peak_in_flight = 0;
+
+  bool stopped = false;
+
+  /** Caller is blocked in take */
+  bool waiting = false;
+
+  std::vector<const asection *> queue;
+
+  std::map<const asection *, slot> slots;
+
+  mutable std::mutex lock;
+
+  std::condition_variable changed;
+
+  std::thread worker;
+};
+}  // namespace befa
+
+#endif //BEFA_PREFETCHER_HPP
@@ -0,0 +1,206 @@
+//
+// Created by miro on 10/18/26.
+//
+
+#ifndef BEFA_REGISTERS_HPP
+#define BEFA_REGISTERS_HPP
+
+#include <string_view>
+
+#include "../utils/perfect_hash.hpp"
+#include "instruction_parser.hpp"
+
+/**
+ * List of known registers: X(reg, type, parent, offset)
+ *
+ *  reg    is register name prefixed by '_' (that's how it's printed)
+ *  type   is one of symbol_table::types
+ *  parent is the widest register this one is part of
+ *  offset is position (in bits) of this register inside of the parent,
+ *         flags are their own parents and offset is bit in RFLAGS
+ */
+#define ASM_REGISTER_TABLE(X) \
+  X(_rax,   QWORD, _rax,    0) \
+  X(_al,    BYTE,  _rax,    0) \
+  X(_ah,    BYTE,  _rax,    8) \
+  X(_ax,    WORD,  _rax,    0) \
+  X(_eax,   DWORD, _rax,    0) \
+  X(_rbx,   QWORD, _rbx,    0) \
+  X(_bl,    BYTE,  _rbx,    0) \
+  X(_bh,    BYTE,  _rbx,    8) \
+  X(_bx,    WORD,  _rbx,    0) \
+  X(_ebx,   DWORD, _rbx,    0) \
+  X(_rcx,   QWORD, _rcx,    0) \
+  X(_cl,    BYTE,  _rcx,    0) \
+  X(_ch,    BYTE,  _rcx,    8) \
+  X(_cx,    WORD,  _rcx,    0) \
+  X(_ecx,   DWORD, _rcx,    0) \
+  X(_rdx,   QWORD, _rdx,    0) \
+  X(_dl,    BYTE,  _rdx,    0) \
+  X(_dh,    BYTE,  _rdx,    8) \
+  X(_dx,    WORD,  _rdx,    0) \
+  X(_edx,   DWORD, _rdx,    0) \
+  X(_rdi,   QWORD, _rdi,    0) \
+  X(_di,    WORD,  _rdi,    0) \
+  X(_edi,   DWORD, _rdi,    0) \
+  X(_rsi,   QWORD, _rsi,    0) \
+  X(_si,    WORD,  _rsi,    0) \
+  X(_esi,   DWORD, _rsi,    0) \
+  X(_rsp,   QWORD, _rsp,    0) \
+  X(_sp,    WORD,  _rsp,    0) \
+  X(_esp,   DWORD, _rsp,    0) \
+  X(_rbp,   QWORD, _rbp,    0) \
+  X(_bp,    WORD,  _rbp,    0) \
+  X(_ebp,   DWORD, _rbp,    0) \
+  X(_rip,   QWORD, _rip,    0) \
+  X(_ip,    WORD,  _rip,    0) \
+  X(_eip,   DWORD, _rip,    0) \
+  X(_rcs,   QWORD, _rcs,    0) \
+  X(_cs,    WORD,  _rcs,    0) \
+  X(_ecs,   DWORD, _rcs,    0) \
+  X(_rds,   QWORD, _rds,    0) \
+  X(_ds,    WORD,  _rds,    0) \
+  X(_eds,   DWORD, _rds,    0) \
+  X(_res,   QWORD, _res,    0) \
+  X(_es,    WORD,  _res,    0) \
+  X(_ees,   DWORD, _res,    0) \
+  X(_rfs,   QWORD, _rfs,    0) \
+  X(_fs,    WORD,  _rfs,    0) \
+  X(_efs,   DWORD, _rfs,    0) \
+  X(_rgs,   QWORD, _rgs,    0) \
+  X(_gs,    WORD,  _rgs,    0) \
+  X(_egs,   DWORD, _rgs,    0) \
+  X(_rss,   QWORD, _rss,    0) \
+  X(_ss,    WORD,  _rss,    0) \
+  X(_ess,   DWORD, _rss,    0) \
+  X(_cf,    BIT,   _cf,     0) \
+  X(_pf,    BIT,   _pf,     2) \
+  X(_af,    BIT,   _af,     4) \
+  X(_zf,    BIT,   _zf,     6) \
+  X(_sf,    BIT,   _sf,     7) \
+  X(_tf,    BIT,   _tf,     8) \
+  X(_if,    BIT,   _if,     9) \
+  X(_df,    BIT,   _df,    10) \
+  X(_of,    BIT,   _of,    11) \
+  X(_iopl,  BIT,   _iopl,  12) \
+  X(_nt,    BIT,   _nt,    14) \
+  X(_rf,    BIT,   _rf,    16) \
+  X(_vm,    BIT,   _vm,    17) \
+  X(_ac,    BIT,   _ac,    18) \
+  X(_vif,   BIT,   _vif,   19) \
+  X(_vip,   BIT,   _vip,   20) \
+  X(_id,    BIT,   _id,    21) \
+  X(_r8,    QWORD, _r8,     0) \
+  X(_r8d,   DWORD, _r8,     0) \
+  X(_r8w,   WORD,  _r8,     0) \
+  X(_r8b,   BYTE,  _r8,     0) \
+  X(_r8h,   BYTE,  _r8,     8) \
+  X(_r9,    QWORD, _r9,     0) \
+  X(_r9d,   DWORD, _r9,     0) \
+  X(_r9w,   WORD,  _r9,     0) \
+  X(_r9b,   BYTE,  _r9,     0) \
+  X(_r9h,   BYTE,  _r9,     8) \
+  X(_r10,   QWORD, _r10,    0) \
+  X(_r10d,  DWORD, _r10,    0) \
+  X(_r10w,  WORD,  _r10,    0) \
+  X(_r10b,  BYTE,  _r10,    0) \
+  X(_r10h,  BYTE,  _r10,    8) \
+  X(_r11,   QWORD, _r11,    0) \
+  X(_r11d,  DWORD, _r11,    0) \
+  X(_r11w,  WORD,  _r11,    0) \
+  X(_r11b,  BYTE,  _r11,    0) \
+  X(_r11h,  BYTE,  _r11,    8) \
+  X(_r12,   QWORD, _r12,    0) \
+  X(_r12d,  DWORD, _r12,    0) \
+  X(_r12w,  WORD,  _r12,    0) \
+  X(_r12b,  BYTE,  _r12,    0) \
+  X(_r12h,  BYTE,  _r12,    8) \
+  X(_r13,   QWORD, _r13,    0) \
+  X(_r13d,  DWORD, _r13,    0) \
+  X(_r13w,  WORD,  _r13,    0) \
+  X(_r13b,  BYTE,  _r13,    0) \
+  X(_r13h,  BYTE,  _r13,    8) \
+  X(_r14,   QWORD, _r14,    0) \
+  X(_r14d,  DWORD, _r14,    0) \
+  X(_r14w,  WORD,  _r14,    0) \
+  X(_r14b,  BYTE,  _r14,    0) \
+  X(_r14h,  BYTE,  _r14,    8) \
+  X(_r15,   QWORD, _r15,    0) \
+  X(_r15d,  DWORD, _r15,    0) \
+  X(_r15w,  WORD,  _r15,    0) \
+  X(_r15b,  BYTE,  _r15,    0) \
+  X(_r15h,  BYTE,  _r15,    8) \
+  X(_xmm0,  XMM,   _xmm0,   0) \
+  X(_xmm1,  XMM,   _xmm1,   0) \
+  X(_xmm2,  XMM,   _xmm2,   0) \
+  X(_xmm3,  XMM,   _xmm3,   0) \
+  X(_xmm4,  XMM,   _xmm4,   0) \
+  X(_xmm5,  XMM,   _xmm5,   0) \
+  X(_xmm6,  XMM,   _xmm6,   0) \
+  X(_xmm7,  XMM,   _xmm7,   0)
+
+namespace symbol_table {
+
+/**
+ * Dense register id, index into register_info (and get_register)
+ */
+enum class RegisterId : uint8_t {
+#define REGISTER_ID(reg, type, parent, offset) reg,
+  ASM_REGISTER_TABLE(REGISTER_ID)
+#undef REGISTER_ID
+  count
+};
+
+constexpr size_t register_count = (size_t) RegisterId::count;
+
+/**
+ * Static metadata of register
+ */
+struct RegisterInfo {
+  /** name as it appears in disassembly (without '_') */
+  std::string_view name;
+  /** in bits */
+  size_t           width;
+  RegisterId       parent;
+  uint8_t          offset;
+};
+
+constexpr RegisterInfo register_info[register_count] = {
+#define REGISTER_INFO(reg, type, parent, offset) \
+  {std::string_view(#reg).substr(1), types::type_trait<types::type>::size, \
+   RegisterId::parent, offset},
+  ASM_REGISTER_TABLE(REGISTER_INFO)
+#undef REGISTER_INFO
+};
+
+namespace details {
+constexpr std::string_view register_names[register_count] = {
+#define REGISTER_NAME(reg, type, parent, offset) \
+  std::string_view(#reg).substr(1),
+  ASM_REGISTER_TABLE(REGISTER_NAME)
+#undef REGISTER_NAME
+};
+
+constexpr PerfectHash<register_count, 2048> register_hash(register_names);
+}  // namespace details
+
+/**
+ * @param name of register as it appears in disassembly (eax, r8d, ...)
+ * @return id of register or RegisterId::count if there is no such register
+ */
+constexpr RegisterId find_register(std::string_view name) noexcept {
+  return (RegisterId) details::register_hash.find(name);
+}
+
+/**
+ * @return static register symbol (do not delete, @see register_deleter)
+ */
+VisitableBase *get_register(RegisterId id) noexcept;
+
+/**
+ * @return id of static register symbol or RegisterId::count for any other
+ */
+RegisterId register_id(const VisitableBase *symbol) noexcept;
+}  // namespace symbol_table
+
+#endif //BEFA_REGISTERS_HPP
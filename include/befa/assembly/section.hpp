@@ -11,7 +11,7 @@ namespace befa {
 struct Section {
   Section(const asection *origin) : origin(origin) {}
 
-  std::string getName() { return origin->name; }
+  std::string getName() const { return origin->name; }
 
   const asection *getOrigin() const { return origin; }
 
@@ -21,21 +21,25 @@ struct Symbol {
   // ~~~~~~~~~~~~~~ Conversions ~~~~~~~~~~~~~~
   Symbol(Symbol<SectionT> &&rhs)
       : origin(std::move(rhs.origin)),
-        parent(std::move(rhs.parent)) {}
+        parent(std::move(rhs.parent)),
+        content_hash(rhs.content_hash) {}
 
   Symbol &operator=(Symbol<SectionT> &&rhs) {
     origin = std::move(rhs.origin);
     parent = std::move(rhs.parent);
+    content_hash = rhs.content_hash;
     return *this;
   }
 
   Symbol(const Symbol<SectionT> &rhs)
       : origin(rhs.origin),
-        parent(rhs.parent) {}
+        parent(rhs.parent),
+        content_hash(rhs.content_hash) {}
 
   Symbol &operator=(const Symbol<SectionT> &rhs) {
     origin = rhs.origin;
     parent = rhs.parent;
+    content_hash = rhs.content_hash;
     return *this;
   }
   // ~~~~~~~~~~~~~~ Conversions ~~~~~~~~~~~~~~
@@ -85,6 +89,14 @@ struct Symbol {
         ) != aliases.cend());
   }
 
+  /**
+   * Hash of decoded contents with masked addresses (0 if not decoded)
+   * @see llvm::FunctionCache
+   */
+  uint64_t getContentHash() const { return content_hash; }
+
+  void setContentHash(uint64_t hash) { content_hash = hash; }
+
   // ~~~~~~~~~~~~~~ Aliases ~~~~~~~~~~~~~~
   std::vector<std::shared_ptr<Symbol>> getAliases() const {
     return ::map(
@@ -140,6 +152,11 @@ struct Symbol {
    * Alias holder
    */
   std::vector<asymbol *> aliases;
+
+  /**
+   * Set by disassembler
+   */
+  uint64_t content_hash = 0;
 };
 }  // namespace befa
 
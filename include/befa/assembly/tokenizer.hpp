@@ -0,0 +1,281 @@
+//
+// Created by miro on 10/18/26.
+//
+
+#ifndef BEFA_TOKENIZER_HPP
+#define BEFA_TOKENIZER_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include <vector>
+
+#if defined(__SSE2__)
+# include <emmintrin.h>
+#endif
+
+namespace befa {
+namespace details {
+/**
+ * Position of piece (mnemonic or operand) in decoded instruction
+ */
+struct piece_slice {
+  uint32_t offset;
+  uint32_t length;
+};
+
+/**
+ * Character classes of text, one bit per character
+ *
+ * Classified 16 characters at a time (SSE2), text of usual instruction
+ * fits into fixed arrays, longer one is classified into heap.
+ */
+struct char_classes {
+  /** 256 characters without heap */
+  static constexpr size_t inline_words = 4;
+
+  explicit char_classes(std::string_view text) : size(text.size()) {
+    size_t words = (size + 63) / 64;
+    if (words > inline_words) {
+      heap.resize(words * 3);
+      word = heap.data();
+      hex = word + words;
+      start = hex + words;
+    }
+    for (size_t i = 0; i < words; ++i)
+      classify(text, i);
+  }
+
+  char_classes(const char_classes &) = delete;
+  char_classes &operator=(const char_classes &) = delete;
+
+  /** [A-Za-z0-9_] */
+  bool is_word(size_t i) const { return test(word, i); }
+
+  /** [0-9a-fA-F] */
+  bool is_hex(size_t i) const { return test(hex, i); }
+
+  /**
+   * @return first position from i, that is not word character (or size)
+   */
+  size_t word_end(size_t i) const { return find(word, i, true); }
+
+  /**
+   * @return first position from i, that is not hex digit (or size)
+   */
+  size_t hex_end(size_t i) const { return find(hex, i, true); }
+
+  /**
+   * @return first position from i, where piece can begin (or size)
+   */
+  size_t next_start(size_t i) const { return find(start, i, false); }
+
+ private:
+  bool test(const uint64_t *mask, size_t i) const {
+    return i < size && (mask[i / 64] >> (i % 64)) & 1;
+  }
+
+  /**
+   * @param inverted looks for cleared bit instead
+   */
+  size_t find(const uint64_t *mask, size_t i, bool inverted) const {
+    size_t words = (size + 63) / 64;
+    for (size_t index = i / 64; index < words; ++index) {
+      uint64_t bits = inverted ? ~mask[index] : mask[index];
+      if (index == i / 64)
+        bits &= ~0ull << (i % 64);
+      if (bits) {
+        size_t found = index * 64 + __builtin_ctzll(bits);
+        return found < size ? found : size;
+      }
+    }
+    return size;
+  }
+
+  /**
+   * Classifies characters [64 * index, 64 * index + 64)
+   */
+  void classify(std::string_view text, size_t index) {
+    uint64_t word_bits = 0, hex_bits = 0, start_bits = 0;
+    for (size_t block = 0; block < 4; ++block) {
+      size_t offset = index * 64 + block * 16;
+      if (offset >= size)
+        break;
+      // zeros do not belong to any class
+      char chars[16] = {};
+      std::memcpy(chars, text.data() + offset, std::min<size_t>(16, size - offset));
+
+      uint32_t w, h, s;
+      classify_block(chars, w, h, s);
+      word_bits |= (uint64_t) w << (block * 16);
+      hex_bits |= (uint64_t) h << (block * 16);
+      start_bits |= (uint64_t) s << (block * 16);
+    }
+    word[index] = word_bits;
+    hex[index] = hex_bits;
+    start[index] = start_bits;
+  }
+
+#if defined(__SSE2__)
+  /**
+   * @return mask of lo <= c <= hi (unsigned)
+   */
+  static __m128i in_range(__m128i chars, char lo, char hi) {
+    __m128i shifted = _mm_sub_epi8(chars, _mm_set1_epi8(lo));
+    return _mm_cmpeq_epi8(
+        _mm_min_epu8(shifted, _mm_set1_epi8((char) (hi - lo))), shifted
+    );
+  }
+
+  static void classify_block(
+      const char *chars,
+      uint32_t &word,
+      uint32_t &hex,
+      uint32_t &start
+  ) {
+    __m128i v = _mm_loadu_si128((const __m128i *) chars);
+    __m128i lower = _mm_or_si128(v, _mm_set1_epi8(0x20));
+    __m128i digit = in_range(v, '0', '9');
+    __m128i is_hex = _mm_or_si128(digit, in_range(lower, 'a', 'f'));
+    __m128i is_word = _mm_or_si128(
+        _mm_or_si128(digit, in_range(lower, 'a', 'z')),
+        _mm_cmpeq_epi8(v, _mm_set1_epi8('_'))
+    );
+    __m128i is_start = _mm_or_si128(
+        _mm_or_si128(is_word, _mm_cmpeq_epi8(v, _mm_set1_epi8('.'))),
+        _mm_or_si128(
+            _mm_cmpeq_epi8(v, _mm_set1_epi8('#')),
+            _mm_cmpeq_epi8(v, _mm_set1_epi8('['))
+        )
+    );
+    word = (uint32_t) _mm_movemask_epi8(is_word);
+    hex = (uint32_t) _mm_movemask_epi8(is_hex);
+    start = (uint32_t) _mm_movemask_epi8(is_start);
+  }
+#else
+  static void classify_block(
+      const char *chars,
+      uint32_t &word,
+      uint32_t &hex,
+      uint32_t &start
+  ) {
+    word = hex = start = 0;
+    for (uint32_t i = 0; i < 16; ++i) {
+      char c = chars[i], lower = (char) (c | 0x20);
+      bool digit = c >= '0' && c <= '9';
+      bool is_word = digit || (lower >= 'a' && lower <= 'z') || c == '_';
+      word |= (uint32_t) is_word << i;
+      hex |= (uint32_t) (digit || (lower >= 'a' && lower <= 'f')) << i;
+      start |= (uint32_t) (is_word || c == '.' || c == '#' || c == '[') << i;
+    }
+  }
+#endif
+
+  size_t size;
+  uint64_t inline_masks[3][inline_words];
+  std::vector<uint64_t> heap;
+  uint64_t *word = inline_masks[0];
+  uint64_t *hex = inline_masks[1];
+  uint64_t *start = inline_masks[2];
+};
+}  // namespace details
+
+/**
+ * Splits decoded instruction into pieces (mnemonic and operands)
+ *
+ * Produces the same pieces as parse_regex (@see details::split), which is
+ * tried at every position in this order:
+ *  1. \w*\.\w+                            (whole match)
+ *  2. # 0x0*[0-9a-fA-F]+                  (empty piece)
+ *  3. \w+ PTR (?:\w+:)?\[[^\]]+\]         (whole match)
+ *  4. \[([^]]+)\]                         (inside of brackets)
+ *  5. 0x0*?([0-9a-fA-F]+)                 (digits)
+ *  6. \w+                                 (whole match)
+ *
+ * @param text is decoded instruction
+ * @param slices are appended with positions of pieces in text
+ */
+inline void tokenize(
+    std::string_view text,
+    std::vector<details::piece_slice> &slices
+) {
+  using details::piece_slice;
+  details::char_classes classes(text);
+  size_t size = text.size();
+  auto emit = [&slices](size_t offset, size_t length) {
+    slices.push_back(piece_slice{(uint32_t) offset, (uint32_t) length});
+  };
+  auto at = [&text, size](size_t i, char c) {
+    return i < size && text[i] == c;
+  };
+  auto close_bracket = [&text](size_t open) {
+    // [^\]]+ needs at least one character
+    size_t close = text.find(']', open + 1);
+    return close == std::string_view::npos || close == open + 1
+           ? std::string_view::npos : close;
+  };
+
+  for (size_t i = classes.next_start(0); i < size;
+       i = classes.next_start(i)) {
+    size_t word_end = classes.word_end(i);
+
+    // 1. (\w*\.\w+)
+    if (at(word_end, '.') && classes.is_word(word_end + 1)) {
+      size_t end = classes.word_end(word_end + 1);
+      emit(i, end - i);
+      i = end;
+      continue;
+    }
+
+    // 2. # 0x0*[0-9a-fA-F]+
+    if (text.compare(i, 4, "# 0x") == 0 && classes.is_hex(i + 4)) {
+      emit(0, 0);
+      i = classes.hex_end(i + 4);
+      continue;
+    }
+
+    // 3. (\w+ PTR (?:\w+:)?\[[^\]]+\])
+    if (word_end > i && text.compare(word_end, 5, " PTR ") == 0) {
+      size_t open = word_end + 5;
+      size_t segment = classes.word_end(open);
+      if (segment > open && at(segment, ':'))
+        open = segment + 1;
+      size_t close = at(open, '[') ? close_bracket(open) : std::string_view::npos;
+      if (close != std::string_view::npos) {
+        emit(i, close + 1 - i);
+        i = close + 1;
+        continue;
+      }
+    }
+
+    // 4. \[([^]]+)\]
+    if (text[i] == '[') {
+      size_t close = close_bracket(i);
+      if (close != std::string_view::npos) {
+        emit(i + 1, close - i - 1);
+        i = close + 1;
+        continue;
+      }
+    }
+
+    // 5. 0x0*?([0-9a-fA-F]+)
+    if (text[i] == '0' && at(i + 1, 'x') && classes.is_hex(i + 2)) {
+      size_t end = classes.hex_end(i + 2);
+      emit(i + 2, end - i - 2);
+      i = end;
+      continue;
+    }
+
+    // 6. (\w+\w+\w+) | (\w+)
+    if (word_end > i) {
+      emit(i, word_end - i);
+      i = word_end;
+      continue;
+    }
+    ++i;
+  }
+}
+}  // namespace befa
+
+#endif //BEFA_TOKENIZER_HPP
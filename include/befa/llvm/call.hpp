@@ -50,6 +50,16 @@ struct CallFactory
       sym_table_t::ptr::shared  symbol_table,
       ir_t::rx::shared_subs     subscriber
   )   const                     override;
+
+  bool                          handles(
+      befa::Mnemonic            mnemonic
+  )   const                     override;
+
+  void                          lift(
+      a_ir_t::c_info::ref       i,
+      sym_table_t::ptr::shared  symbol_table,
+      CompactFunction&          function
+  )   const                     override;
 };
 
 }  // namespace llvm
@@ -23,22 +23,11 @@ struct CmpInstruction
         EQ,                 NE,
 
         // unsigned GT      unsigned GE
-        UGT = GT,           UGE = GE,
+        UGT,                UGE,
         // unsigned LT      unsigned LE
-        ULT = LT,           ULE = LE,
+        ULT,                ULE,
   };
 
-  // FIXME: remove this
-  static
-  std::map<
-      std::string,               types_e
-  >   str_to_jmp;
-  static
-  std::map<
-      CmpInstruction::types_e,
-      std::vector<std::string>
-  >                              jumps;
-
   void accept(
       VisitorBase&               visitor
   )   const                      override {
@@ -47,6 +36,18 @@ struct CmpInstruction
 
   std::string                  toString() const override;
 
+  /**
+   * @return compare operation this was constructed with
+   */
+  types_e                        getPredicate() const { return predicate; }
+
+  /**
+   * @return name of predicate as it is printed (eq, ult, ...)
+   */
+  static const std::string&      predicateName(
+      types_e                    predicate
+  );
+
   /**
    *
    * @param result where to safe the output of comparition
@@ -64,6 +65,8 @@ struct CmpInstruction
   );
 
  private:
+  types_e                        predicate;
+
   static inline
   std::string              fetch_name(
       const sym_t::ptr::shared&  result,
@@ -83,6 +86,16 @@ struct CompareFactory
       sym_table_t::ptr::shared   symbol_table,
       ir_t::rx::shared_subs      subscriber
   )   const                      override;
+
+  bool                           handles(
+      befa::Mnemonic             mnemonic
+  )   const                      override;
+
+  void                           lift(
+      a_ir_t::c_info::ref        instruction,
+      sym_table_t::ptr::shared   symbol_table,
+      CompactFunction&           function
+  )   const                      override;
 };
 }  // namespace llvm
 
@@ -0,0 +1,185 @@
+//
+// Created by miro on 10/18/26.
+//
+
+#ifndef BEFA_COMPACT_HPP
+#define BEFA_COMPACT_HPP
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "instruction.hpp"
+#include "assignment.hpp"
+#include "binary_operation.hpp"
+#include "cmp.hpp"
+
+namespace llvm {
+
+/**
+ * Lifted function as fixed-size records
+ *
+ * Operands are 32-bit ids into table of values of the function, assembly
+ * instructions are stored once and records refer to them by index. Class
+ * hierarchy (BinaryOperation, CmpInstruction, ...) is only a view, objects
+ * are created on demand by view().
+ *
+ * Built-in factories write records directly (@see LLVMFactory::lift),
+ * instructions of other factories are kept as they are (OPAQUE records).
+ */
+struct CompactFunction {
+  using sym_t =                  traits::symbol;
+  using ir_t =                   traits::ir;
+  using a_ir_t =                 traits::a_ir;
+  using value_id =               uint32_t;
+
+  /** Unused operand of record */
+  static constexpr value_id      no_value = (value_id) -1;
+
+  enum kind_e : uint8_t {
+    BINARY,
+    UNARY,
+    COMPARE,
+    CALL,
+    BRANCH,
+    OPAQUE,
+  };
+
+  /**
+   * One lifted instruction
+   *
+   * operands are definition first and then used values, OPAQUE records
+   * store index of instruction in operands[0]
+   */
+  struct Record {
+    kind_e                       kind;
+    /** CmpInstruction::types_e of COMPARE */
+    uint8_t                      predicate;
+    /** index of operator (BINARY, UNARY) */
+    uint16_t                     op;
+    /** index of assembly instruction */
+    uint32_t                     assembly;
+    value_id                     operands[3];
+  };
+
+  // ~~~~~ Construction (the same shapes as in class hierarchy)
+  void                           binary(
+      a_ir_t::c_info::ref        assembly,
+      const sym_t::ptr::shared&  target,
+      const sym_t::ptr::shared&  lhs,
+      const std::string&         op,
+      const sym_t::ptr::shared&  rhs
+  );
+
+  void                           unary(
+      a_ir_t::c_info::ref        assembly,
+      const sym_t::ptr::shared&  target,
+      const std::string&         op,
+      const sym_t::ptr::shared&  operand
+  );
+
+  void                           compare(
+      a_ir_t::c_info::ref        assembly,
+      const sym_t::ptr::shared&  result,
+      const sym_t::ptr::shared&  lhs,
+      CmpInstruction::types_e    predicate,
+      const sym_t::ptr::shared&  rhs
+  );
+
+  void                           call(
+      a_ir_t::c_info::ref        assembly,
+      const sym_t::ptr::shared&  result,
+      const sym_t::ptr::shared&  target
+  );
+
+  void                           branch(
+      a_ir_t::c_info::ref        assembly,
+      const sym_t::ptr::shared&  condition,
+      const sym_t::ptr::shared&  target
+  );
+
+  /**
+   * Keeps instruction without record of its own
+   */
+  void                           append(
+      const ir_t::ptr::shared&   instruction
+  );
+  // ~~~~~ Construction
+
+  size_t                         size() const { return records.size(); }
+
+  const Record&                  record(
+      size_t                     index
+  )   const                      { return records[index]; }
+
+  const sym_t::ptr::shared&      value(
+      value_id                   id
+  )   const                      { return values[id]; }
+
+  /**
+   * @return assembly instruction of record
+   */
+  a_ir_t::c_info::ref            getAssembly(
+      const Record&              record
+  )   const                      { return assembly[record.assembly]; }
+
+  /**
+   * @return operator of BINARY and UNARY record
+   */
+  const std::string&             getOperator(
+      const Record&              record
+  )   const                      { return operators[record.op]; }
+
+  /**
+   * @return instance of class hierarchy for record at index
+   */
+  ir_t::ptr::shared              view(
+      size_t                     index
+  )   const;
+
+  /**
+   * @return number of distinct values (operands) of function
+   */
+  size_t                         valueCount() const { return values.size(); }
+
+ private:
+  /**
+   * Consecutive records of one assembly instruction share it
+   */
+  uint32_t                       intern_assembly(
+      a_ir_t::c_info::ref        instruction
+  );
+
+  value_id                       intern_value(
+      const sym_t::ptr::shared&  value
+  );
+
+  uint16_t                       intern_operator(
+      const std::string&         op
+  );
+
+  void                           push(
+      kind_e                     kind,
+      a_ir_t::c_info::ref        instruction,
+      uint16_t                   op,
+      uint8_t                    predicate,
+      const sym_t::ptr::shared&  first,
+      const sym_t::ptr::shared&  second,
+      const sym_t::ptr::shared&  third
+  );
+
+  std::vector<Record>            records;
+  std::vector<
+      a_ir_t::info::type
+  >                              assembly;
+  std::vector<sym_t::ptr::shared> values;
+  std::unordered_map<
+      const void *, value_id
+  >                              value_ids;
+  std::vector<std::string>       operators;
+  std::vector<ir_t::ptr::shared> opaque;
+};
+}  // namespace llvm
+
+#endif //BEFA_COMPACT_HPP
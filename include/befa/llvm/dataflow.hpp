@@ -0,0 +1,189 @@
+//
+// Created by miro on 10/18/26.
+//
+
+#ifndef BEFA_DATAFLOW_HPP
+#define BEFA_DATAFLOW_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "../utils/bit_vector.hpp"
+#include "../assembly/registers.hpp"
+#include "flow_graph.hpp"
+
+namespace llvm {
+
+using befa::BitVector;
+
+enum direction_e {
+  FORWARD,
+  BACKWARD,
+};
+
+// ~~~~~ Lattices
+/**
+ * May analysis (liveness, reaching definitions), bottom is empty set
+ */
+struct UnionMeet {
+  static constexpr bool        top = false;
+
+  static void meet(BitVector &into, const BitVector &value) { into |= value; }
+};
+
+/**
+ * Must analysis (available expressions), top is full set
+ */
+struct IntersectionMeet {
+  static constexpr bool        top = true;
+
+  static void meet(BitVector &into, const BitVector &value) { into &= value; }
+};
+// ~~~~~ Lattices
+
+/**
+ * Problem with transfer out = gen | (in & ~kill) for every block
+ *
+ * @tparam LatticeT is UnionMeet or IntersectionMeet
+ * @tparam Direction of analysis
+ */
+template<
+    typename                   LatticeT,
+    direction_e                Direction
+>
+struct GenKillProblem {
+  using lattice =              LatticeT;
+  static constexpr direction_e direction = Direction;
+
+  GenKillProblem(
+      size_t                   blocks,
+      size_t                   bits
+  ) : gen                     (blocks, BitVector(bits))
+    , kill                    (blocks, BitVector(bits))
+    , outside                 (bits) {}
+
+  size_t bits() const { return outside.size(); }
+
+  /**
+   * Value flowing in from outside of function into block
+   */
+  void boundary(uint32_t, BitVector &value) const { value = outside; }
+
+  /**
+   * @return true if output has changed
+   */
+  bool transfer(
+      uint32_t                 block,
+      const BitVector &        input,
+      BitVector &              output
+  )   const {
+    return output.transfer(gen[block], input, kill[block]);
+  }
+
+  std::vector<BitVector>       gen;
+  std::vector<BitVector>       kill;
+  /** @see boundary */
+  BitVector                    outside;
+};
+
+/**
+ * Values at the beginning (in) and at the end (out) of every block
+ */
+struct DataflowSolution {
+  std::vector<BitVector>       in;
+  std::vector<BitVector>       out;
+};
+
+/**
+ * Worklist solver of dataflow problems over blocks of function
+ *
+ * Blocks are visited in reverse postorder (postorder for backward
+ * problems) and revisited only when their input has changed. Problem has
+ * to provide:
+ *
+ *  lattice     @see UnionMeet, IntersectionMeet
+ *  direction   FORWARD or BACKWARD
+ *  bits()      size of values
+ *  boundary(block, value)
+ *              value coming from outside of function, into entry block
+ *              (FORWARD) or out of blocks that leave function (BACKWARD)
+ *  transfer(block, input, output)
+ *              computes output of block, returns true if it has changed
+ *
+ * @see GenKillProblem
+ */
+template<typename ProblemT>
+DataflowSolution solve_dataflow(
+    const FlowGraph &          graph,
+    const ProblemT &           problem
+) {
+  using lattice = typename ProblemT::lattice;
+  constexpr bool forward = ProblemT::direction == FORWARD;
+  auto &blocks = graph.blocks;
+
+  BitVector top(problem.bits(), lattice::top);
+  DataflowSolution solution{
+      std::vector<BitVector>(blocks.size(), top),
+      std::vector<BitVector>(blocks.size(), top)
+  };
+  auto &input = forward ? solution.in : solution.out;
+  auto &output = forward ? solution.out : solution.in;
+
+  std::vector<uint32_t> order = graph.reversePostorder();
+  if (!forward)
+    std::reverse(order.begin(), order.end());
+
+  std::vector<bool> dirty(blocks.size(), true);
+  for (bool changed = true; changed;) {
+    changed = false;
+    for (auto block : order) {
+      if (!dirty[block])
+        continue;
+      dirty[block] = false;
+
+      // ~~~~~ Meet
+      auto &sources = forward ? blocks[block].predecessors
+                              : blocks[block].successors;
+      bool leaves = forward ? block == 0
+                            : blocks[block].unknown_exit || sources.empty();
+      BitVector &value = input[block];
+      if (leaves)
+        problem.boundary(block, value);
+      else if (sources.empty())
+        value = top;
+      for (size_t i = 0; i < sources.size(); ++i)
+        if (i == 0 && !leaves)
+          value = output[sources[i]];
+        else
+          lattice::meet(value, output[sources[i]]);
+      // ~~~~~ Meet
+
+      if (!problem.transfer(block, value, output[block]))
+        continue;
+      auto &targets = forward ? blocks[block].successors
+                              : blocks[block].predecessors;
+      for (auto target : targets)
+        dirty[target] = changed = true;
+    }
+  }
+  return solution;
+}
+
+/**
+ * @return bit of register in sets of registers, parts of register (eax,
+ *         ax, al) share bit of the widest one, every flag has its own
+ */
+constexpr size_t                 register_bit(
+    symbol_table::RegisterId     id
+) {
+  return (size_t) symbol_table::register_info[(size_t) id].parent;
+}
+
+/**
+ * Number of bits of set of registers (@see register_bit)
+ */
+constexpr size_t                 register_bits = symbol_table::register_count;
+}  // namespace llvm
+
+#endif //BEFA_DATAFLOW_HPP
@@ -0,0 +1,58 @@
+//
+// Created by miro on 10/18/26.
+//
+
+#ifndef BEFA_FLAGS_HPP
+#define BEFA_FLAGS_HPP
+
+#include <cstdint>
+#include <vector>
+
+#include "flow_graph.hpp"
+
+namespace llvm {
+
+/**
+ * Status flags as bits of mask
+ */
+enum flag_e : uint8_t {
+  CF        = 1 << 0,
+  PF        = 1 << 1,
+  ZF        = 1 << 2,
+  SF        = 1 << 3,
+  OF        = 1 << 4,
+  ALL_FLAGS = CF | PF | ZF | SF | OF,
+};
+
+/**
+ * @return flags read by jcc, setcc and cmovcc (0 for the rest)
+ */
+uint8_t                          flags_read(
+    befa::Mnemonic               mnemonic
+);
+
+/**
+ * @return flags (re)defined by instructions that are lifted (cmp, test)
+ */
+uint8_t                          flags_defined(
+    befa::Mnemonic               mnemonic
+);
+
+/**
+ * Backward flag liveness (@see solve_dataflow)
+ *
+ * Flags are live after instruction if some jcc, setcc or cmovcc reads
+ * them before the next cmp/test. Every block is walked backwards from
+ * flags live at its end (read by successors, all of them on unknown exit).
+ *
+ * @param function are instructions of function
+ * @param graph of the same function
+ * @return flags live after every instruction
+ */
+std::vector<uint8_t>             flag_liveness(
+    const FlowGraph::a_ir_t::vector::value &function,
+    const FlowGraph &            graph
+);
+}  // namespace llvm
+
+#endif //BEFA_FLAGS_HPP
@@ -0,0 +1,73 @@
+//
+// Created by miro on 10/18/26.
+//
+
+#ifndef BEFA_FLOW_GRAPH_HPP
+#define BEFA_FLOW_GRAPH_HPP
+
+#include <cstdint>
+#include <vector>
+
+#include "instruction.hpp"
+
+namespace llvm {
+
+/**
+ * Control flow graph of one function (over its assembly instructions)
+ *
+ * Blocks are found from instructions themselves: they begin at the first
+ * instruction, at targets of direct jumps and after jumps and returns.
+ * Jumps that can't be followed (indirect, out of function), falling
+ * off the end of function and instructions which mention jump or return
+ * that is not their mnemonic are marked as unknown exits.
+ */
+struct FlowGraph {
+  using a_ir_t =                 traits::a_ir;
+
+  struct Block {
+    /** Instructions [begin, end) */
+    uint32_t                     begin;
+    uint32_t                     end;
+
+    std::vector<uint32_t>        successors;
+    std::vector<uint32_t>        predecessors;
+
+    /** Control flow leaves function in a way we can't follow */
+    bool                         unknown_exit = false;
+  };
+
+  /**
+   * @param function are instructions of function in order of addresses
+   */
+  explicit FlowGraph(
+      const a_ir_t::vector::value &function
+  );
+
+  /**
+   * @return blocks (entry first), reachable in reverse postorder and then
+   *         unreachable ones in order of addresses
+   */
+  const std::vector<uint32_t>&   reversePostorder() const { return order; }
+
+  /**
+   * @return block containing instruction at index
+   */
+  uint32_t                       blockOf(
+      uint32_t                   instruction
+  )   const;
+
+  std::vector<Block>             blocks;
+
+ private:
+  std::vector<uint32_t>          order;
+};
+
+/**
+ * @return target of direct jump (jcc, jmp) or -1
+ */
+bfd_vma                          jump_target(
+    FlowGraph::a_ir_t::c_info::ref instruction
+);
+}  // namespace llvm
+
+#endif //BEFA_FLOW_GRAPH_HPP
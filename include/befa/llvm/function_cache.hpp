@@ -0,0 +1,281 @@
+//
+// Created by miro on 10/18/26.
+//
+
+#ifndef BEFA_FUNCTION_CACHE_HPP
+#define BEFA_FUNCTION_CACHE_HPP
+
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+#include "instruction.hpp"
+
+namespace llvm {
+
+/**
+ * Content addressed cache of decoded and lifted functions
+ *
+ * Key is a hash of function's bytes in which instructions referencing
+ * addresses (calls, jumps, rip-relative operands, ...) are masked, so the
+ * same library function linked into another binary, or to another address,
+ * produces the same key. Key is seeded with instruction set of binary.
+ *
+ * Such relocation-sensitive instructions are always decoded and lifted
+ * again, everything else is taken from the cache. Entries can be kept
+ * in a directory to be shared between runs; only decoded instructions
+ * are stored there, lifted instructions live in memory.
+ *
+ * Cache is thread safe, entries are immutable once inserted.
+ */
+struct FunctionCache {
+  using hash_t =                 uint64_t;
+  using a_ir_t =                 traits::a_ir;
+  using ir_t =                   traits::ir;
+
+  /**
+   * Decoded instruction relative to the beginning of its function
+   */
+  struct CachedInstruction {
+    uint32_t                     offset;
+    uint32_t                     size;
+
+    /** Decoded text depends on the address, decode it again */
+    bool                         relocatable;
+
+    /** Lifted form depends on the binary (ie. references function) */
+    bool                         relift;
+
+    /** Result of jump matching (-1 if this is not a jump) */
+    uint64_t                     jump;
+
+    /** Decoded text (empty if instruction is relocatable) */
+    std::string                  decoded;
+  };
+
+  /**
+   * Lifted instruction paired with offset of its assembly instruction
+   */
+  using lifted_t =               std::vector<
+      std::pair<uint32_t,        ir_t::ptr::shared>
+  >;
+
+  struct Entry {
+    std::vector<CachedInstruction> instructions;
+
+    /** Sorted by offset */
+    lifted_t                     lifted;
+
+    /** Offsets of instructions which are lifted again (sorted) */
+    std::vector<uint32_t>        relift;
+
+    /** If function has been lifted (lifted may be empty anyway) */
+    bool                         has_lifted = false;
+  };
+
+  using entry_t =                types::traits::container<Entry>;
+
+  /**
+   * FNV-1a of function, fed by instructions in order
+   */
+  struct Hasher {
+    Hasher() = default;
+
+    /**
+     * Seeds hash with instruction set, so the same bytes decoded for
+     * another machine don't share key
+     *
+     * @param arch of binary (bfd_get_arch)
+     * @param machine of binary (bfd_get_mach)
+     * @param options of disassembler
+     */
+    Hasher(
+        uint32_t                 arch,
+        uint64_t                 machine,
+        std::string_view         options
+    );
+
+    /**
+     * @param bytes of instruction
+     * @param size of instruction
+     * @param relocatable if true, address dependent bytes are masked
+     * @param address of instruction
+     * @param target is address printed by decoder, field that encodes it
+     *        (rel32, disp32, ...) is masked, if it can't be found the last
+     *        4 bytes are
+     */
+    void                         add(
+        const uint8_t *          bytes,
+        size_t                   size,
+        bool                     relocatable,
+        bfd_vma                  address = 0,
+        bfd_vma                  target = 0
+    );
+
+    hash_t                       digest() const { return value; }
+
+   private:
+    void                         feed(uint8_t byte) {
+      value = (value ^ byte) * 1099511628211ull;
+    }
+
+    hash_t                       value = 14695981039346656037ull;
+  };
+
+  /**
+   * @param directory for on-disk store, empty string means memory only
+   */
+  FunctionCache(
+      std::string                directory = ""
+  ) : directory                 (directory) {}
+
+  /**
+   * @return entry or nullptr (looks into directory on miss)
+   */
+  entry_t::c_ptr::shared         find(
+      hash_t                     hash
+  );
+
+  /**
+   * Stores decoded function (replaces older one)
+   */
+  void                           insert(
+      hash_t                     hash,
+      Entry                      entry
+  );
+
+  /**
+   * Attaches lifted instructions to stored function
+   *
+   * @param relift are offsets of instructions that cannot be reused
+   */
+  void                           insert_lifted(
+      hash_t                     hash,
+      lifted_t                   lifted,
+      const std::vector<uint32_t> &relift
+  );
+
+  size_t                         size() const;
+
+  /**
+   * Rebuilds lifted instruction, so it belongs to another assembly
+   * instruction
+   *
+   * @return nullptr if type of instruction is unknown
+   */
+  static ir_t::ptr::shared       rebase(
+      const ir_t::ptr::shared&   instruction,
+      a_ir_t::c_info::ref        assembly
+  );
+
+ private:
+  std::string                    path(hash_t hash) const;
+
+  entry_t::c_ptr::shared         load(hash_t hash) const;
+
+  void                           store(hash_t hash, const Entry &entry) const;
+
+  std::string                    directory;
+
+  std::unordered_map<
+      hash_t,                    entry_t::c_ptr::shared
+  >                              entries;
+
+  mutable std::mutex             lock;
+};
+
+/**
+ * Lifting state of InstructionMapper, replays functions that are
+ * already lifted and records those which are not
+ *
+ * Only functions decoded through the cache are recorded (decoded entry
+ * tells which instructions are relocation-sensitive). Replayed instructions
+ * share symbols with instructions they were recorded from.
+ */
+struct CacheSession {
+  using hash_t =                 FunctionCache::hash_t;
+  using entry_t =                FunctionCache::entry_t;
+  using lifted_t =               FunctionCache::lifted_t;
+  using a_ir_t =                 traits::a_ir;
+  using ir_t =                   traits::ir;
+
+  /**
+   * Function of instruction, taken when instruction is received (its
+   * basic block can be released before it is lifted in streaming mode)
+   */
+  struct Function {
+    /** Symbol (only for identity) */
+    const void *                 identity = nullptr;
+
+    bfd_vma                      address = 0;
+
+    hash_t                       hash = 0;
+  };
+
+  CacheSession(
+      std::shared_ptr<FunctionCache> cache
+  ) : cache                     (cache) {}
+
+  /**
+   * @return function of instruction (empty one without basic block)
+   */
+  static Function                function_of(
+      a_ir_t::c_info::ref        instruction
+  );
+
+  /**
+   * Switches to function, instructions passed to replay are of it
+   * (previous function is finished)
+   */
+  void                           begin(
+      const Function &           function
+  );
+
+  /**
+   * Emits cached lifted form of instruction (of function passed to begin)
+   *
+   * @return false if instruction has to be lifted by factories
+   *         (created instructions are then recorded)
+   */
+  bool                           replay(
+      a_ir_t::c_info::ref        instruction,
+      ir_t::rx::shared_subs      subscriber
+  );
+
+  /**
+   * Called with every instruction created by mapper
+   */
+  void                           record(
+      const ir_t::ptr::shared&   instruction
+  );
+
+  /**
+   * Publishes function that has been recorded
+   */
+  void                           finish();
+
+ private:
+  std::shared_ptr<FunctionCache> cache;
+
+  /** Function being lifted */
+  Function                       function;
+
+  entry_t::c_ptr::shared         entry;
+
+  /** Recording of current function */
+  lifted_t                       lifted;
+
+  std::vector<uint32_t>          relift;
+
+  /** Function is being recorded */
+  bool                           recording = false;
+
+  /** Instruction created now belongs to the offset */
+  bool                           capturing = false;
+
+  uint32_t                       offset = 0;
+};
+}  // namespace llvm
+
+#endif //BEFA_FUNCTION_CACHE_HPP
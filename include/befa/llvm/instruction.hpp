@@ -5,7 +5,9 @@
 #ifndef BEFA_LLVM_LLVM_INSTRUCTION_HPP
 #define BEFA_LLVM_LLVM_INSTRUCTION_HPP
 
+#include <array>
 #include <tuple>
+#include <unordered_map>
 #include <memory>
 #include <rxcpp/rx.hpp>
 
@@ -155,6 +157,9 @@ using                InstructionTraits =visitable_traits      <LLVM_VISITABLES>;
 struct           InstructionMapper;
 struct           SymTable;
 struct           LLVMFactory;
+struct           FunctionCache;
+struct           CacheSession;
+struct           CompactFunction;
 
 namespace traits {
 // ~~~~~ Assembly instruction aliases
@@ -343,9 +348,11 @@ struct Instruction
   ) {
     std::string result = "_asm {\n";
     for (auto &instr : assembly) {
-      result += "\t" + instr.getName() + "\n";
+      result += '\t';
+      result += instr.getMnemonic();
+      result += '\n';
     }
-    return result + "}\n";
+    return result += "}\n";
   }
 };
 
@@ -402,6 +409,32 @@ struct LLVMFactory {
       // side-effect output in form of llvm instruction stream
       ir_t::rx::shared_subs      llvm_subscriber
   ) const = 0;
+
+  /**
+   * Asked once at registration, instructions with other mnemonics
+   * are not passed into this factory at all
+   *
+   * @param mnemonic is id of mnemonic (Mnemonic::unknown for the rest)
+   * @return true if this factory reduces instructions with this mnemonic
+   */
+  virtual bool                   handles(
+      befa::Mnemonic
+  ) const {
+    return true;
+  }
+
+  /**
+   * Reduces instruction into records of compact function
+   *
+   * Default one keeps instructions created by operator() as they are
+   *
+   * @see CompactFunction
+   */
+  virtual void                   lift(
+      a_ir_t::c_info::ref        asm_ir,
+      sym_table_t::ptr::shared   sym_table,
+      CompactFunction&           function
+  ) const;
 };
 
 /**
@@ -410,18 +443,35 @@ struct LLVMFactory {
 struct SymTable {
   using sym_t =                  traits::symbol;
   using sym_map_t =              traits::sym_map;
+  using pool_t =                 instruction_parser::pool_t;
 
   /**
    * Create mapper with symbol table
+   *
+   * @param symbol_map has to be changed only via add_symbol from now on
+   *        (lookups are served from indices built here)
    */
   SymTable(
       sym_map_t::ptr::shared     symbol_map
-  ) : symbol_map                (symbol_map) {}
+  );
 
   /**
-   * Finds symbol by its address
+   * Function-local symbol table layered over global one
+   *
+   * Lookups fall through into global, new symbols are stored only here,
+   * so global can be shared by more threads (it must not change meanwhile)
+   *
+   * @param global is read-only symbol table (not layered itself)
+   * @see merge
+   */
+  explicit SymTable(
+      std::shared_ptr<const SymTable> global
+  );
+
+  /**
+   * Finds symbol by its name
    *
-   * @param address in string format
+   * @param name under which symbol is stored in symbol map (eg. zf)
    * @return pointer to VisitableBase or nullptr
    */
   sym_t::ptr::shared             find_symbol(
@@ -431,13 +481,23 @@ struct SymTable {
   /**
    * Finds symbol by its address
    *
-   * @param address in string format
+   * @param address of symbol
    * @return pointer to VisitableBase or nullptr
    */
   sym_t::ptr::shared             find_symbol(
       bfd_vma                    address
   )   const;
 
+  /**
+   * Finds symbol whose name contains part (walks whole symbol map)
+   *
+   * @param part of symbol's name (eg. _zf matches ((BIT)_zf))
+   * @return first of such symbols or nullptr
+   */
+  sym_t::ptr::shared             find_symbol_containing(
+      const std::string &        part
+  )   const;
+
   /**
    * @param sym is pointer to symbol
    * @return virtual memory address of symbol
@@ -447,12 +507,30 @@ struct SymTable {
   )   const;
 
   /**
-   * @return RO map with bfd_vma instead of string
+   * @return RO map with bfd_vma instead of string (copy of address_map)
    */
   instruction_parser::sym_map_t
   ::type                      to_map() const;
 
+  /**
+   * Symbols by their addresses, kept up to date by add_symbol
+   * (for getArgs, the first symbol on the address wins)
+   *
+   * @return view valid as long as this symbol table (and global one)
+   */
+  instruction_parser::lookup_t
+  ::type                      address_map() const;
+
   // ~~~~~ Mutable operations (can be used as an accumulator in rxcpp reduce)
+  /**
+   * Adds symbols of function-local table, that are not here yet
+   *
+   * @param local is table layered over this one
+   */
+  void                           merge(
+      const SymTable &           local
+  );
+
   sym_t::ptr::shared             add_symbol(
       sym_t::ptr::shared         symbol
   );
@@ -477,18 +555,72 @@ struct SymTable {
       std::string                name,
       ArgsT&&...                 args
   ) {
-    auto ite = symbol_map->find(name);
-    if (ite != symbol_map->end())
-      return ite->second;
+    if (auto symbol = find_symbol(name))
+      return symbol;
     return add_symbol<T>(std::forward<ArgsT>(args)...);
   }
   // ~~~~~ Mutable operations
 
+  /**
+   * @return operands of currently reduced batch (can be nullptr)
+   * @see instruction_parser::getArgs
+   */
+  const pool_t::ptr::shared&     getPool() const { return pool; }
+
+  void                           setPool(
+      pool_t::ptr::shared        pool
+  ) { this->pool = std::move(pool); }
+
+  /**
+   * @return flags (llvm::flag_e) read after currently lifted instruction,
+   *         factories may skip computation of the others
+   * @see InstructionMapper::set_flag_liveness
+   */
+  uint8_t                        getLiveFlags() const { return live_flags; }
+
+  void                           setLiveFlags(
+      uint8_t                    flags
+  ) { live_flags = flags; }
+
  protected:
+  /**
+   * Stores symbol into indices (the first one stays on collision)
+   */
+  void                           index_symbol(
+      const std::string &        name,
+      const sym_t::ptr::shared & symbol
+  );
+
   /**
    * Mapper-scoped symbol table
    */
   sym_map_t::ptr::shared         symbol_map;
+
+  // ~~~~~ Indices of symbol_map
+  std::unordered_map<
+      std::string, sym_t::ptr::shared
+  >                              by_name;
+  std::unordered_map<
+      bfd_vma, sym_t::ptr::shared
+  >                              by_address;
+  /**
+   * ordered and with symbols without address (-1), as getArgs expects
+   * (only added ones, if this table is layered over global)
+   */
+  instruction_parser::sym_map_t
+  ::type                         addresses;
+  // ~~~~~ Indices of symbol_map
+
+  /** Table this one is layered over (or nullptr) */
+  std::shared_ptr<const SymTable> global;
+
+  /** all of them, unless mapper knows better */
+  uint8_t                        live_flags = 0xff;
+
+  /**
+   * Set by InstructionMapper for time of reduction
+   */
+  pool_t::ptr::shared            pool;
 };
 
 /**
@@ -528,6 +660,37 @@ struct InstructionMapper {
       a_ir_t ::rx::obs           o$
   );
 
+  /**
+   * Lifts every function on its own, functions are spread over workers
+   *
+   * Instructions are grouped into functions by symbol of their basic block
+   * and every function is reduced into SymTable layered over symbol table
+   * of this mapper. When all of them are lifted, their symbols are merged
+   * into symbol table and created instructions are emitted into
+   * observable() in order of functions, so the result doesn't depend
+   * on number of workers. Symbols created by factories (eg. TempResult)
+   * are not shared between functions.
+   *
+   * @param o$ is input observable
+   * @param workers is number of threads (0 for hardware concurrency)
+   * @return symbol table once the input completes (as reduce_instr)
+   */
+  sym_table_t::rx::shared_obs    reduce_functions(
+      a_ir_t ::rx::obs           o$,
+      size_t                     workers = 0
+  );
+
+  /**
+   * Lifts instructions of one function into compact form (nothing is
+   * emitted into observable(), function cache is not used)
+   *
+   * @param function are instructions of function
+   * @return records of lifted instructions
+   */
+  std::shared_ptr<CompactFunction> lift_compact(
+      const a_ir_t::vector::value &function
+  );
+
   /**
    * Expects that derivations of this will contain observable of instructions
    */
@@ -568,6 +731,55 @@ struct InstructionMapper {
       const fact_t::ptr::raw     ptr
   );
 
+  /**
+   * Reuses lifted instructions of functions that has been already lifted
+   * (functions has to be decoded through the same cache)
+   *
+   * @param cache is shared cache of functions
+   * @see FunctionCache
+   */
+  void set_function_cache(
+      std::shared_ptr<FunctionCache> cache
+  );
+
+  /**
+   * Reuses operands of instructions with the same decoded text
+   * (memo can be shared by more mappers)
+   *
+   * @param memo or nullptr to parse every instruction
+   * @see befa::ParseMemo
+   */
+  void set_parse_memo(
+      std::shared_ptr<befa::ParseMemo> memo
+  );
+
+  /**
+   * Computes flags only if they are read (by jcc, setcc, cmovcc) before
+   * they are redefined, instead of after every cmp and test
+   *
+   * reduce_instr then lifts instructions when their function is complete
+   *
+   * @param enabled turns on flag liveness (off by default)
+   * @see flag_liveness
+   */
+  void set_flag_liveness(
+      bool                       enabled
+  );
+
+  /**
+   * Lifts cmp/test followed by jcc of the same basic block into one
+   * compare with predicate of jcc and a branch, if flags are not read
+   * after jcc (not used with function cache)
+   *
+   * reduce_instr then lifts instructions when their function is complete
+   *
+   * @param enabled turns on fusion (off by default)
+   * @see BranchFusion
+   */
+  void set_branch_fusion(
+      bool                       enabled
+  );
+
  protected:
   /**
    * Copy cons - new factories
@@ -578,12 +790,65 @@ struct InstructionMapper {
       const InstructionMapper&   self
   );
 
+  /**
+   * Lifts instructions of function with flag liveness and branch fusion
+   * (if they are turned on)
+   */
+  void                           lift_planned(
+      const a_ir_t::vector::value &function,
+      const sym_table_t::ptr::shared &table,
+      const ir_t::rx::shared_subs &output,
+      CacheSession *             session
+  )   const;
+
+  /**
+   * Replays instruction from cache session or passes it to factories
+   */
+  void                           lift_instruction(
+      a_ir_t::c_info::ref        i,
+      const sym_table_t::ptr::shared &table,
+      const ir_t::rx::shared_subs &output,
+      CacheSession *             session
+  )   const;
+
+  /**
+   * Reduces instructions of one function
+   *
+   * @param function are instructions of function
+   * @param local is function-local symbol table
+   * @param session of function cache begun with function (or nullptr)
+   * @return created instructions in order
+   */
+  ir_t::vector::shared           lift_function(
+      const a_ir_t::vector::value &function,
+      const sym_table_t::ptr::shared &local,
+      const std::shared_ptr<CacheSession> &session
+  )   const;
+
+  /**
+   * Rebuilds dispatch table from factories
+   */
+  void update_dispatch(
+  );
+
  protected:
   sym_table_t::ptr::shared       symbol_table;
   fact_t::vector::shared         factories;
+  /** mnemonic id -> factories that handles it (in order of registration) */
+  std::array<
+      fact_t::vector::shared,
+      befa::mnemonic_count + 1
+  >                              dispatch;
   addr_t::vector::value          traversed_addresses;
   InstructionVisitorL            append_traversed_addr;
   ir_t::rx::shared_subj          created_instructions;
+  std::shared_ptr<CacheSession>  cache_session;
+  /** records created instructions into cache_session */
+  rxcpp::composite_subscription  cache_recording;
+  std::shared_ptr<FunctionCache> function_cache;
+  std::shared_ptr<befa::ParseMemo> parse_memo;
+  bool                           use_flag_liveness = false;
+  bool                           use_branch_fusion = false;
 };
 
 #ifndef INSTRUCTION_TEST
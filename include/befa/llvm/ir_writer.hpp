@@ -0,0 +1,85 @@
+//
+// Created by miro on 10/18/26.
+//
+
+#ifndef BEFA_IR_WRITER_HPP
+#define BEFA_IR_WRITER_HPP
+
+#include <string_view>
+
+#include "../utils/output_sink.hpp"
+#include "compact.hpp"
+
+namespace llvm {
+
+/**
+ * Writes lifted instructions as text straight into sink
+ *
+ * Text is the same as toString() of instructions, but it is not built
+ * from intermediate strings: names of symbols are written as they are
+ * (temporaries render their names once) and assignments, compares, ...
+ * are put together in the sink. Unknown instructions fall back to
+ * toString().
+ */
+struct IrWriter {
+  using sym_t =                  traits::symbol;
+  using ir_t =                   traits::ir;
+  using a_ir_t =                 traits::a_ir;
+
+  explicit IrWriter(
+      befa::OutputSink&          sink
+  ) : sink                      (sink) {}
+
+  /**
+   * Writes text of instruction->toString()
+   */
+  void                           write(
+      const ir_t::ptr::shared&   instruction
+  );
+
+  /**
+   * Writes text of function.view(record)->toString() (without view)
+   */
+  void                           write(
+      const CompactFunction&     function,
+      size_t                     record
+  );
+
+  /**
+   * Writes every record of function on its own line
+   */
+  void                           write(
+      const CompactFunction&     function
+  );
+
+  /**
+   * Writes text of Instruction::toString() (assembly of instruction)
+   */
+  void                           writeAssembly(
+      const Instruction&         instruction
+  );
+
+  /**
+   * Writes name of symbol, nothing if it is not symbol
+   */
+  void                           writeSymbol(
+      const sym_t::ptr::shared&  symbol
+  );
+
+ private:
+  struct                         Visitor;
+
+  /**
+   * Writes name of Temporary(lhs, op, rhs) (result of operation)
+   */
+  void                           write_result(
+      const sym_t::ptr::shared&  lhs,
+      std::string_view           op,
+      const sym_t::ptr::shared&  rhs
+  );
+
+  befa::OutputSink&              sink;
+};
+}  // namespace llvm
+
+#endif //BEFA_IR_WRITER_HPP
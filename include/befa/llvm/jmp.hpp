@@ -113,6 +113,54 @@ struct JumpFactory
       sym_table_t::ptr::shared   symbol_table,
       ir_t::rx::shared_subs      subscriber
   )   const                      override;
+
+  bool                           handles(
+      befa::Mnemonic             mnemonic
+  )   const                      override;
+
+  void                           lift(
+      a_ir_t::c_info::ref        instruction,
+      sym_table_t::ptr::shared   symbol_table,
+      CompactFunction&           function
+  )   const                      override;
+};
+
+/**
+ * Peephole for cmp/test that is followed by jcc
+ *
+ * Pair is lifted into one CmpInstruction with predicate of jcc and one
+ * BranchInstruction, flags are not computed at all.
+ *
+ * @see InstructionMapper::set_branch_fusion
+ */
+struct BranchFusion {
+  using a_ir_t =                 traits::a_ir;
+  using ir_t =                   traits::ir;
+  using sym_table_t =            traits::sym_table;
+
+  /**
+   * @param compare is mnemonic of the first instruction
+   * @param jump is mnemonic of the second one
+   * @return true if instructions can be lifted together
+   */
+  static bool                    fusable(
+      befa::Mnemonic             compare,
+      befa::Mnemonic             jump
+  );
+
+  void                           operator()(
+      a_ir_t::c_info::ref        compare,
+      a_ir_t::c_info::ref        jump,
+      sym_table_t::ptr::shared   symbol_table,
+      ir_t::rx::shared_subs      subscriber
+  )   const;
+
+  void                           lift(
+      a_ir_t::c_info::ref        compare,
+      a_ir_t::c_info::ref        jump,
+      sym_table_t::ptr::shared   symbol_table,
+      CompactFunction&           function
+  )   const;
 };
 
 }  // namespace llvm
@@ -0,0 +1,211 @@
+//
+// Created by miro on 10/18/26.
+//
+
+#ifndef BEFA_SSA_HPP
+#define BEFA_SSA_HPP
+
+#include <cstdint>
+#include <vector>
+
+#include "../utils/range.hpp"
+#include "compact.hpp"
+#include "flow_graph.hpp"
+
+namespace llvm {
+
+/**
+ * SSA form of lifted function with def-use chains
+ *
+ * Variables are symbols of records (registers, flags, temporaries) that
+ * have the same name, immediates and functions are not variables. Every
+ * definition of variable is new value, phis are placed on iterated
+ * dominance frontiers (dominators by Cooper, Harvey and Kennedy) of blocks
+ * for variables that are read before being defined in some block.
+ * Variables read before any definition get one LIVE_IN value each.
+ *
+ * Values, uses and phi operands are dense ids into flat arrays, the form
+ * is built once and then only read, so it can be shared by passes.
+ */
+struct SsaForm {
+  using a_ir_t =                 traits::a_ir;
+  using sym_t =                  traits::symbol;
+  using value_id =               uint32_t;
+
+  /** Operand of phi from unreachable predecessor */
+  static constexpr value_id      no_value = (value_id) -1;
+
+  enum kind_e : uint8_t {
+    /** defined by record */
+    RECORD,
+    /** defined by phi */
+    PHI,
+    /** variable at the beginning of function */
+    LIVE_IN,
+  };
+
+  struct Value {
+    uint32_t                     variable;
+    kind_e                       kind;
+    /** index of record or phi (0 for LIVE_IN) */
+    uint32_t                     position;
+  };
+
+  struct Phi {
+    uint32_t                     block;
+    value_id                     result;
+  };
+
+  /**
+   * Use of value, operand is index into uses of record (@see usesOf)
+   * or into operands of phi (@see operandsOf)
+   */
+  struct Use {
+    kind_e                       kind;
+    uint32_t                     user;
+    uint32_t                     operand;
+  };
+
+  using value_range =            ::details::range<const value_id *>;
+  using use_range =              ::details::range<const Use *>;
+
+  /**
+   * @param function are instructions of function in order of addresses
+   * @param lifted is function lifted by InstructionMapper::lift_compact
+   */
+  SsaForm(
+      const a_ir_t::vector::value &function,
+      const CompactFunction &    lifted
+  );
+
+  // ~~~~~ Values
+  size_t                         valueCount() const { return values.size(); }
+
+  const Value&                   value(
+      value_id                   id
+  )   const                      { return values[id]; }
+
+  /**
+   * @return def -> use, every use of value
+   */
+  use_range                      usersOf(
+      value_id                   id
+  )   const;
+  // ~~~~~ Values
+
+  // ~~~~~ Variables
+  size_t                         variableCount() const {
+    return variables.size();
+  }
+
+  /**
+   * @return one of symbols of variable
+   */
+  const sym_t::ptr::shared&      variable(
+      uint32_t                   id
+  )   const                      { return variables[id]; }
+  // ~~~~~ Variables
+
+  // ~~~~~ Records
+  /**
+   * @return values defined by record at index
+   */
+  value_range                    definedBy(
+      size_t                     record
+  )   const;
+
+  /**
+   * @return use -> def, values read by record at index
+   */
+  value_range                    usesOf(
+      size_t                     record
+  )   const;
+
+  uint32_t                       blockOfRecord(
+      size_t                     record
+  )   const                      { return record_block[record]; }
+  // ~~~~~ Records
+
+  // ~~~~~ Phis
+  size_t                         phiCount() const { return phis.size(); }
+
+  const Phi&                     phi(
+      size_t                     index
+  )   const                      { return phis[index]; }
+
+  /**
+   * @return values incoming from predecessors of phi's block (in order
+   *         of FlowGraph::Block::predecessors), phis of entry block have
+   *         one more operand for LIVE_IN value of variable
+   */
+  value_range                    operandsOf(
+      size_t                     phi
+  )   const;
+
+  /**
+   * @return phis of block as [first, last) indices
+   */
+  std::pair<uint32_t, uint32_t>  phisOf(
+      uint32_t                   block
+  )   const;
+  // ~~~~~ Phis
+
+  /**
+   * @return immediate dominator of block (entry for itself),
+   *         -1 for unreachable blocks
+   */
+  uint32_t                       immediateDominator(
+      uint32_t                   block
+  )   const                      { return idom[block]; }
+
+  const FlowGraph&               graph() const { return flow; }
+
+ private:
+  void                           compute_dominators();
+
+  /**
+   * Dominance frontier of block b is frontier[begin[b], begin[b + 1])
+   */
+  void                           compute_frontiers(
+      std::vector<uint32_t>&     begin,
+      std::vector<uint32_t>&     frontier
+  )   const;
+
+  /**
+   * record_defs and record_uses hold variables at this point
+   */
+  void                           place_phis();
+
+  /**
+   * Replaces variables of records by their values
+   */
+  void                           rename();
+
+  void                           link_uses();
+
+  FlowGraph                      flow;
+  std::vector<uint32_t>          idom;
+
+  std::vector<sym_t::ptr::shared> variables;
+  std::vector<Value>             values;
+
+  /** records: block, defined values, used values (CSR) */
+  std::vector<uint32_t>          record_block;
+  std::vector<uint32_t>          record_defs_begin;
+  std::vector<value_id>          record_defs;
+  std::vector<uint32_t>          record_uses_begin;
+  std::vector<value_id>          record_uses;
+
+  /** phis are sorted by block */
+  std::vector<Phi>               phis;
+  std::vector<uint32_t>          block_phis_begin;
+  std::vector<uint32_t>          phi_operands_begin;
+  std::vector<value_id>          phi_operands;
+
+  /** users of values (CSR) */
+  std::vector<uint32_t>          users_begin;
+  std::vector<Use>               users;
+};
+}  // namespace llvm
+
+#endif //BEFA_SSA_HPP
@@ -0,0 +1,125 @@
+//
+// Created by miro on 10/18/26.
+//
+
+#ifndef BEFA_ARENA_HPP
+#define BEFA_ARENA_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace befa {
+
+/**
+ * Bump allocator, objects are destroyed (and memory freed) all at once
+ * with the arena
+ *
+ * Use shared handles (@see Arena::handle), they keep the whole arena alive
+ * instead of counting every object separately. Not thread safe.
+ */
+struct Arena
+    : public std::enable_shared_from_this<Arena> {
+  explicit Arena(
+      size_t                   chunk_size = 16 * 1024
+  ) : chunk_size              (chunk_size) {}
+
+  Arena(const Arena &) = delete;
+  Arena &operator=(const Arena &) = delete;
+
+  ~Arena() {
+    // reverse order, later objects can reference earlier ones
+    for (auto ite = destructors.rbegin(); ite != destructors.rend(); ++ite)
+      ite->second(ite->first);
+  }
+
+  /**
+   * Constructs object inside of arena
+   * @return pointer valid as long as this arena
+   */
+  template<
+      typename                 T,
+      typename...              ArgsT
+  >
+  T *create(ArgsT &&...args) {
+    void *memory = allocate(sizeof(T), alignof(T));
+    if (std::is_trivially_destructible<T>::value)
+      return new(memory) T(std::forward<ArgsT>(args)...);
+
+    // reserved first, so object is never left without destructor
+    destructors.emplace_back(nullptr, &destroy<T>);
+    try {
+      T *object = new(memory) T(std::forward<ArgsT>(args)...);
+      destructors.back().first = object;
+      return object;
+    } catch (...) {
+      destructors.pop_back();
+      throw;
+    }
+  }
+
+  /**
+   * Constructs object inside of arena (arena has to be owned by shared_ptr)
+   * @return pointer that shares ownership of the whole arena
+   */
+  template<
+      typename                 T,
+      typename...              ArgsT
+  >
+  std::shared_ptr<T> handle(ArgsT &&...args) {
+    return std::shared_ptr<T>(
+        shared_from_this(), create<T>(std::forward<ArgsT>(args)...)
+    );
+  }
+
+  /**
+   * @return uninitialized memory valid as long as this arena
+   */
+  void *allocate(size_t size, size_t alignment) {
+    size_t padding = (alignment - (size_t) current % alignment) % alignment;
+    if (!current || padding + size > (size_t) (end - current)) {
+      // big objects get their own chunk
+      size_t chunk = std::max(chunk_size, size + alignment);
+      chunks.emplace_back(new char[chunk]);
+      current = chunks.back().get();
+      end = current + chunk;
+      allocated += chunk;
+      padding = (alignment - (size_t) current % alignment) % alignment;
+    }
+    void *memory = current + padding;
+    current += padding + size;
+    used += padding + size;
+    return memory;
+  }
+
+  /**
+   * @return bytes given out by allocate
+   */
+  size_t size() const { return used; }
+
+  /**
+   * @return bytes taken from heap
+   */
+  size_t capacity() const { return allocated; }
+
+ private:
+  template<typename T>
+  static void destroy(void *object) {
+    static_cast<T *>(object)->~T();
+  }
+
+  size_t                                         chunk_size;
+  std::vector<std::unique_ptr<char[]>>           chunks;
+  char                                          *current = nullptr;
+  char                                          *end = nullptr;
+  size_t                                         used = 0;
+  size_t                                         allocated = 0;
+  std::vector<std::pair<void *, void (*)(void *)>> destructors;
+};
+}  // namespace befa
+
+#endif //BEFA_ARENA_HPP
@@ -0,0 +1,128 @@
+//
+// Created by miro on 10/18/26.
+//
+
+#ifndef BEFA_BIT_VECTOR_HPP
+#define BEFA_BIT_VECTOR_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace befa {
+
+/**
+ * Dense set of bits with fixed size
+ *
+ * Set operations work on whole 64-bit words in plain loops (compiler
+ * vectorizes them), bits past size() are always zero.
+ */
+class BitVector {
+ public:
+  using word_t = uint64_t;
+  static constexpr size_t word_bits = 64;
+
+  BitVector() = default;
+
+  explicit BitVector(
+      size_t                   bits,
+      bool                     value = false
+  ) : bits                    (bits)
+    , words                   ((bits + word_bits - 1) / word_bits, 0) {
+    if (value)
+      fill(true);
+  }
+
+  size_t size() const { return bits; }
+
+  // ~~~~~ Bits
+  bool test(size_t bit) const {
+    return (words[bit / word_bits] >> (bit % word_bits)) & 1;
+  }
+
+  void set(size_t bit) {
+    words[bit / word_bits] |= (word_t) 1 << (bit % word_bits);
+  }
+
+  void reset(size_t bit) {
+    words[bit / word_bits] &= ~((word_t) 1 << (bit % word_bits));
+  }
+
+  void fill(bool value) {
+    for (auto &word : words)
+      word = value ? ~(word_t) 0 : 0;
+    if (value && bits % word_bits)
+      words.back() &= ((word_t) 1 << (bits % word_bits)) - 1;
+  }
+
+  bool any() const {
+    word_t any = 0;
+    for (auto word : words)
+      any |= word;
+    return any != 0;
+  }
+
+  size_t count() const {
+    size_t count = 0;
+    for (auto word : words)
+      count += (size_t) __builtin_popcountll(word);
+    return count;
+  }
+  // ~~~~~ Bits
+
+  // ~~~~~ Sets (of the same size)
+  BitVector &operator|=(const BitVector &rhs) {
+    for (size_t i = 0; i < words.size(); ++i)
+      words[i] |= rhs.words[i];
+    return *this;
+  }
+
+  BitVector &operator&=(const BitVector &rhs) {
+    for (size_t i = 0; i < words.size(); ++i)
+      words[i] &= rhs.words[i];
+    return *this;
+  }
+
+  /**
+   * Removes bits of rhs
+   */
+  BitVector &subtract(const BitVector &rhs) {
+    for (size_t i = 0; i < words.size(); ++i)
+      words[i] &= ~rhs.words[i];
+    return *this;
+  }
+
+  /**
+   * this = gen | (input & ~kill)
+   * @return true if this has changed
+   */
+  bool transfer(
+      const BitVector &        gen,
+      const BitVector &        input,
+      const BitVector &        kill
+  ) {
+    word_t changed = 0;
+    for (size_t i = 0; i < words.size(); ++i) {
+      word_t word = gen.words[i] | (input.words[i] & ~kill.words[i]);
+      changed |= word ^ words[i];
+      words[i] = word;
+    }
+    return changed != 0;
+  }
+
+  bool operator==(const BitVector &rhs) const {
+    return bits == rhs.bits && words == rhs.words;
+  }
+
+  bool operator!=(const BitVector &rhs) const { return !(*this == rhs); }
+  // ~~~~~ Sets
+
+  const word_t *data() const { return words.data(); }
+
+ private:
+  size_t                       bits = 0;
+  std::vector<word_t>          words;
+};
+}  // namespace befa
+
+#endif //BEFA_BIT_VECTOR_HPP
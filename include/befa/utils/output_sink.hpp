@@ -0,0 +1,213 @@
+//
+// Created by miro on 10/18/26.
+//
+
+#ifndef BEFA_OUTPUT_SINK_HPP
+#define BEFA_OUTPUT_SINK_HPP
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <memory>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unistd.h>
+#include <vector>
+
+namespace befa {
+
+/**
+ * Buffered output, text is copied into buffer and passed on when buffer
+ * is full (@see overflow) or on flush()
+ */
+class OutputSink {
+ public:
+  OutputSink(const OutputSink &) = delete;
+  OutputSink &operator=(const OutputSink &) = delete;
+
+  virtual ~OutputSink() = default;
+
+  void write(std::string_view text) {
+    while (!text.empty()) {
+      if (cursor == limit)
+        overflow();
+      size_t size = std::min(text.size(), (size_t) (limit - cursor));
+      std::memcpy(cursor, text.data(), size);
+      cursor += size;
+      text.remove_prefix(size);
+    }
+  }
+
+  void put(char character) {
+    if (cursor == limit)
+      overflow();
+    *cursor++ = character;
+  }
+
+  OutputSink &operator<<(std::string_view text) {
+    write(text);
+    return *this;
+  }
+
+  OutputSink &operator<<(char character) {
+    put(character);
+    return *this;
+  }
+
+  /**
+   * Passes buffered text on (nothing for in-memory sinks)
+   * @raises std::runtime_error
+   */
+  virtual void flush() {}
+
+ protected:
+  OutputSink() = default;
+
+  /**
+   * Makes room for at least one more character
+   */
+  virtual void overflow() = 0;
+
+  void setBuffer(char *begin, char *end) {
+    base = cursor = begin;
+    limit = end;
+  }
+
+  size_t buffered() const { return (size_t) (cursor - base); }
+
+  char *base = nullptr;
+  char *cursor = nullptr;
+  char *limit = nullptr;
+};
+
+/**
+ * Keeps text in memory, in chunks of fixed size (nothing is ever moved)
+ */
+class ChunkedSink
+    : public OutputSink {
+ public:
+  explicit ChunkedSink(
+      size_t                   chunk_size = 64 * 1024
+  ) : chunk_size              (std::max<size_t>(chunk_size, 1)) {}
+
+  /**
+   * @return written text, valid until next write
+   */
+  std::vector<std::string_view> chunks() const {
+    std::vector<std::string_view> chunks;
+    for (size_t i = 0; i < storage.size(); ++i)
+      chunks.emplace_back(
+          storage[i].get(), i + 1 == storage.size() ? buffered() : sizes[i]
+      );
+    return chunks;
+  }
+
+  size_t size() const {
+    size_t size = 0;
+    for (auto chunk : chunks())
+      size += chunk.size();
+    return size;
+  }
+
+  std::string str() const {
+    std::string text;
+    text.reserve(size());
+    for (auto chunk : chunks())
+      text.append(chunk);
+    return text;
+  }
+
+ protected:
+  void overflow() override {
+    if (!storage.empty())
+      sizes.back() = buffered();
+    storage.emplace_back(new char[chunk_size]);
+    sizes.push_back(0);
+    setBuffer(storage.back().get(), storage.back().get() + chunk_size);
+  }
+
+ private:
+  size_t                       chunk_size;
+  std::vector<std::unique_ptr<char[]>> storage;
+  /** sizes of full chunks (last one is buffered()) */
+  std::vector<size_t>          sizes;
+};
+
+/**
+ * Writes into file descriptor (not closed by sink)
+ */
+class FdSink
+    : public OutputSink {
+ public:
+  explicit FdSink(
+      int                      fd,
+      size_t                   buffer_size = 64 * 1024
+  ) : fd                      (fd)
+    , buffer                  (std::max<size_t>(buffer_size, 1)) {
+    setBuffer(buffer.data(), buffer.data() + buffer.size());
+  }
+
+  ~FdSink() override {
+    try {
+      flush();
+    } catch (const std::runtime_error &) {}
+  }
+
+  void flush() override {
+    const char *data = base;
+    size_t size = buffered();
+    cursor = base;
+    while (size) {
+      ssize_t written = ::write(fd, data, size);
+      if (written < 0 && errno == EINTR)
+        continue;
+      if (written < 0)
+        throw std::runtime_error(
+            std::string("cannot write output: ") + std::strerror(errno)
+        );
+      data += written;
+      size -= (size_t) written;
+    }
+  }
+
+ protected:
+  void overflow() override { flush(); }
+
+ private:
+  int                          fd;
+  std::vector<char>            buffer;
+};
+
+/**
+ * Writes into std::ostream in blocks
+ */
+class StreamSink
+    : public OutputSink {
+ public:
+  explicit StreamSink(
+      std::ostream &           stream,
+      size_t                   buffer_size = 64 * 1024
+  ) : stream                  (stream)
+    , buffer                  (std::max<size_t>(buffer_size, 1)) {
+    setBuffer(buffer.data(), buffer.data() + buffer.size());
+  }
+
+  ~StreamSink() override { flush(); }
+
+  void flush() override {
+    stream.write(base, (std::streamsize) buffered());
+    cursor = base;
+  }
+
+ protected:
+  void overflow() override { flush(); }
+
+ private:
+  std::ostream &               stream;
+  std::vector<char>            buffer;
+};
+}  // namespace befa
+
+#endif //BEFA_OUTPUT_SINK_HPP
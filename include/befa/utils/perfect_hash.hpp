@@ -0,0 +1,85 @@
+//
+// Created by miro on 10/18/26.
+//
+
+#ifndef BEFA_PERFECT_HASH_HPP
+#define BEFA_PERFECT_HASH_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+/**
+ * Perfect hash of fixed set of strings, built at compile time
+ *
+ * Seed is searched until every key lands in its own slot, lookup is then
+ * one hash and one string comparison. Keep TableSize ~16x number of keys,
+ * so the seed is found in few tries.
+ *
+ * @tparam N is number of keys (at most 255)
+ * @tparam TableSize is number of slots (power of 2)
+ */
+template<
+    size_t                     N,
+    size_t                     TableSize
+>
+struct PerfectHash {
+  static_assert(N < 0xff, "slots are 8 bit wide");
+  static_assert(
+      TableSize && (TableSize & (TableSize - 1)) == 0,
+      "table size has to be power of 2"
+  );
+
+  /** Marks empty slot, also returned by find when key is unknown */
+  static constexpr size_t npos = N;
+
+  constexpr PerfectHash(const std::string_view (&keys)[N])
+      : keys(keys), seed(0), slots{} {
+    for (seed = 1; !place(); ++seed) {
+      // no seed would be found for duplicate keys
+      if (seed > 0xffff)
+        throw "perfect hash seed not found";
+    }
+  }
+
+  /**
+   * @return index of key in array given to constructor or npos
+   */
+  constexpr size_t find(std::string_view key) const noexcept {
+    size_t index = slots[slot(key, seed)];
+    return index != npos && keys[index] == key ? index : npos;
+  }
+
+ private:
+  static constexpr size_t slot(
+      std::string_view key,
+      uint32_t seed
+  ) noexcept {
+    // FNV-1a, then fibonacci hashing to take the high bits
+    uint32_t hash = 2166136261u ^ (seed * 0x9e3779b9u);
+    for (char c : key) {
+      hash ^= (uint8_t) c;
+      hash *= 16777619u;
+    }
+    hash *= 0x9e3779b9u;
+    return (hash >> 16) & (TableSize - 1);
+  }
+
+  constexpr bool place() {
+    for (auto &index : slots)
+      index = (uint8_t) npos;
+    for (size_t i = 0; i < N; ++i) {
+      auto &index = slots[slot(keys[i], seed)];
+      if (index != npos)
+        return false;
+      index = (uint8_t) i;
+    }
+    return true;
+  }
+
+  const std::string_view *keys;
+  uint32_t seed;
+  uint8_t slots[TableSize];
+};
+
+#endif //BEFA_PERFECT_HASH_HPP
@@ -5,96 +5,82 @@ using basic_block_type = ExecutableFile::bb_t::type;
 using symbol_type = ExecutableFile::sym_t::type;
 using section_type = ExecutableFile::sec_t::type;
 
-int main(int argc, const char **argv) {
-  assert_ex(argc == 2, "missing path parameter");
+struct Printer : public ExecutableFile::visitor_t {
+  Printer(ExecutableFile::var_t::map<bfd_vma>::shared sym_table_symbols)
+      : sym_table_symbols(sym_table_symbols) {}
 
-  // open file + check if file is valid
-  auto file = ExecutableFile::open(*(argv + 1));
+  void sectionBegin(const section_type &sec) override {
+    printf("%s <0x%08lx>:\n",
+           sec.getName().c_str(),
+           sec.getAddress()
+    );
+  }
 
-  assert_ex(file.isValid(), "file is not valid");
+  void symbolBegin(const symbol_type &sym) override {
+    printf("  %s <0x%08lx>:\n",
+           sym.getName().c_str(),
+           sym.getAddress()
+    );
+  }
 
-  auto sym_table_symbols = file.generate_table();
+  void blockBegin(const basic_block_type &bb) override {
+    printf("    BasicBlock #%lu <0x%08lx>:\n",
+           bb.getId(),
+           bb.getId()
+    );
+  }
 
-  file.disassembly()
-      .reduce(
-          // default last basic block,         symbol,         section
-          std::make_tuple((bfd_vma)-1, std::string(""), std::string("")),
-          [&sym_table_symbols](
-              std::tuple<bfd_vma, std::string, std::string> acc,
-              const instr_type &instruction
-          ) {
-            auto bb = instruction.getParent();
-            auto sym = ptr_lock(bb->getParent());
-            auto sec = ptr_lock(sym->getParent());
+  void instruction(const instr_type &instruction) override {
+    // iterate through arguments of instruction
+    instruction
+        .getArgs(sym_table_symbols)
 
-            auto last_sec = sec->getName();
-            auto last_sym = sym->getName();
-            auto last_bb = bb->getId();
+            // convert to string
+        .map([](
+            auto arg
+        ) {
+          return map_visitable<symbol_table::SymbolVisitorL>(
+              arg, [](const symbol_table::Symbol *ptr)
+                   { return ptr->getName(); });
+        })
 
-            if (std::get<2>(acc) != last_sec) {
-              printf("%s <0x%08lx>:\n",
-                     sec->getName().c_str(),
-                     sec->getAddress()
-              );
-            }
-            if (std::get<1>(acc) != last_sym) {
-              printf("  %s <0x%08lx>:\n",
-                     sym->getName().c_str(),
-                     sym->getAddress()
-              );
-            }
-            if (std::get<0>(acc) != last_bb) {
-              printf("    BasicBlock #%lu <0x%08lx>:\n",
-                     bb->getId(),
-                     instruction.getAddress()
-              );
-            }
+            // filter out empty (non-symbol stuff)
+        .filter([](
+            std::string name
+        ) -> bool { return name != ""; })
 
-            // iterate through arguments of instruction
-            instruction
-                .getArgs(sym_table_symbols)
+            // string join achieved by reduction
+        .reduce(std::string(""), [](
+            auto seed, auto b
+        ) {
+          return seed == "" ? b : seed + ", " + b;
+        })
 
-                    // convert to string
-                .map([](
-                    auto arg
-                ) {
-                  return map_visitable<symbol_table::SymbolVisitorL>(
-                      arg, [](const symbol_table::Symbol *ptr)
-                           { return ptr->getName(); });
-                })
+            // print instruction
+        .subscribe([&instruction](
+            auto str_params
+        ) {
+          printf("      <%08lx> %s %s\n",
+                 instruction.getAddress(),
+                 instruction.getName().c_str(),
+                 str_params.c_str());
+        });
+  }
 
-                    // filter out empty (non-symbol stuff)
-                .filter([](
-                    std::string name
-                ) -> bool { return name != ""; })
+ private:
+  ExecutableFile::var_t::map<bfd_vma>::shared sym_table_symbols;
+};
 
-                    // string join achieved by reduction
-                .reduce(std::string(""), [](
-                    auto seed, auto b
-                ) {
-                  return seed == "" ? b : seed + ", " + b;
-                })
+int main(int argc, const char **argv) {
+  assert_ex(argc == 2, "missing path parameter");
 
-                    // print instruction
-                .subscribe([&instruction](
-                    auto str_params
-                ) {
-                  printf("      <%08lx> %s %s\n",
-                         instruction.getAddress(),
-                         instruction.getName().c_str(),
-                         str_params.c_str());
-                });
+  // open file + check if file is valid
+  auto file = ExecutableFile::open(*(argv + 1));
 
-            std::get<2>(acc) = last_sec;
-            std::get<1>(acc) = last_sym;
-            std::get<0>(acc) = last_bb;
+  assert_ex(file.isValid(), "file is not valid");
 
-            return acc;
-          }
-      )
-         // we don't care about result of reduction
-         // cause all is in console
-      .subscribe([](const auto &) {});
-  file.runDisassembler();
+  // sections, symbols and basic blocks are reported by disassembler
+  Printer printer(file.generate_table());
+  file.runDisassembler(printer);
   return 0;
 }
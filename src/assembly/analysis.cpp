@@ -0,0 +1,129 @@
+//
+// Created by miro on 10/18/26.
+//
+
+#include <algorithm>
+#include <fstream>
+#include <stdexcept>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "../../include/befa/assembly/analysis.hpp"
+
+namespace befa {
+
+/**
+ * File format (text):
+ *  befa-analysis 1
+ *  <count>
+ *  <address> <size> <hash> <length>:<name>
+ */
+static const std::string analysis_magic = "befa-analysis";
+static const int analysis_version = 1;
+
+// ~~~~~ Analysis
+void Analysis::save(const std::string &path) const {
+  std::ofstream output(path);
+  if (!output)
+    throw std::runtime_error("cannot open '" + path + "' for writing");
+  output << analysis_magic << " " << analysis_version << "\n"
+         << functions.size() << "\n";
+  for (auto &function : functions)
+    output << function.address << " " << function.size << " "
+           << function.hash << " " << function.name.size() << ":"
+           << function.name << "\n";
+  if (!output)
+    throw std::runtime_error("failed to write '" + path + "'");
+}
+
+Analysis Analysis::load(
+    const std::string &path,
+    std::shared_ptr<llvm::FunctionCache> cache
+) {
+  std::ifstream input(path);
+  if (!input)
+    throw std::runtime_error("cannot open '" + path + "'");
+
+  std::string magic;
+  int version;
+  size_t count;
+  if (!(input >> magic >> version >> count)
+      || magic != analysis_magic || version != analysis_version)
+    throw std::runtime_error("'" + path + "' is not befa analysis");
+
+  Analysis analysis{{}, cache};
+  analysis.functions.reserve(count);
+  for (size_t i = 0; i < count; ++i) {
+    FunctionRecord function{};
+    size_t length;
+    char separator;
+    if (!(input >> function.address >> function.size >> function.hash
+                >> length) || !input.get(separator) || separator != ':')
+      throw std::runtime_error("'" + path + "' is corrupted");
+    function.name.resize(length);
+    if (!input.read(&function.name[0], length))
+      throw std::runtime_error("'" + path + "' is corrupted");
+    analysis.functions.push_back(std::move(function));
+  }
+  return analysis;
+}
+// ~~~~~ Analysis
+
+// ~~~~~ Analysis diff
+AnalysisDiff::AnalysisDiff(
+    const Analysis &previous,
+    const Analysis &current
+) {
+  // names may repeat (ie. static functions), every function matches once
+  std::unordered_multimap<std::string, const FunctionRecord *> by_name;
+  for (auto &function : previous.functions)
+    by_name.emplace(function.name, &function);
+
+  for (auto &function : current.functions) {
+    auto candidates = by_name.equal_range(function.name);
+    if (candidates.first == candidates.second) {
+      added.push_back(function);
+      continue;
+    }
+    // prefer the one with the same contents
+    auto old = std::find_if(
+        candidates.first, candidates.second,
+        [&function](const auto &candidate) {
+          return candidate.second->hash == function.hash
+              && candidate.second->size == function.size;
+        }
+    );
+    if (old == candidates.second) {
+      changed.push_back(function);
+      old = candidates.first;
+    } else {
+      unchanged.push_back(function);
+      moved.emplace(
+          old->second->address, std::make_pair(*old->second, function)
+      );
+    }
+    by_name.erase(old);
+  }
+
+  // the rest has not been matched (kept in order of previous analysis)
+  std::unordered_set<const FunctionRecord *> left;
+  for (auto &item : by_name)
+    left.insert(item.second);
+  for (auto &function : previous.functions)
+    if (left.count(&function))
+      removed.push_back(function);
+}
+
+bfd_vma AnalysisDiff::remap(bfd_vma address) const {
+  auto ite = moved.upper_bound(address);
+  if (ite == moved.begin())
+    return (bfd_vma) -1;
+  --ite;
+  const FunctionRecord &previous = ite->second.first;
+  const FunctionRecord &current = ite->second.second;
+  if (address >= previous.address + previous.size)
+    return (bfd_vma) -1;
+  return current.address + (address - previous.address);
+}
+// ~~~~~ Analysis diff
+}  // namespace befa
@@ -2,273 +2,59 @@
 // Created by miro on 12/3/16.
 //
 
+#include <algorithm>
+#include <charconv>
+#include <unordered_map>
+
 #include "../../include/befa/assembly/instruction_parser.hpp"
+#include "../../include/befa/assembly/parse_memo.hpp"
+#include "../../include/befa/assembly/registers.hpp"
 #include "../../include/befa.hpp"
 #include "../../include/befa/utils/range.hpp"
 
-static std::regex multiplication
-    ("(.+)(\\*)(.+)");
-
-static std::regex add_or_substract
-    ("(.+)(\\+|\\-)(.+)");
-
-static std::regex dereference
-    ("(XMMWORD|BYTE|WORD|DWORD|QWORD) PTR (?:\\w+:)?\\[(.*)\\]");
-
-static std::regex number
-    ("((?:0x0*)?[0-9a-fA-F]+)");
-
-static std::regex address
-    ("(?:0x)?0*([0-9a-fA-F]+)");
-
-
 // registers declarations and definitions
 namespace symbol_table {
-#define DECLARE_REGISTER(name, size) \
-    static Register<size> reg##name(#name);
+#define DECLARE_REGISTER(name, type, parent, offset) \
+    static Register<types::type> reg##name(#name);
 
 #define CAST_TO_VISITABLE(reg) \
     static_cast<VisitableBase *>(&reg)
 
-DECLARE_REGISTER(_rax, types::QWORD)
-DECLARE_REGISTER(_al, types::BYTE)
-DECLARE_REGISTER(_ah, types::BYTE)
-DECLARE_REGISTER(_ax, types::WORD)
-DECLARE_REGISTER(_eax, types::DWORD)
-DECLARE_REGISTER(_rbx, types::QWORD)
-DECLARE_REGISTER(_bl, types::BYTE)
-DECLARE_REGISTER(_bh, types::BYTE)
-DECLARE_REGISTER(_bx, types::WORD)
-DECLARE_REGISTER(_ebx, types::DWORD)
-DECLARE_REGISTER(_rcx, types::QWORD)
-DECLARE_REGISTER(_cl, types::BYTE)
-DECLARE_REGISTER(_ch, types::BYTE)
-DECLARE_REGISTER(_cx, types::WORD)
-DECLARE_REGISTER(_ecx, types::DWORD)
-DECLARE_REGISTER(_rdx, types::QWORD)
-DECLARE_REGISTER(_dl, types::BYTE)
-DECLARE_REGISTER(_dh, types::BYTE)
-DECLARE_REGISTER(_dx, types::WORD)
-DECLARE_REGISTER(_edx, types::DWORD)
-DECLARE_REGISTER(_rdi, types::QWORD)
-DECLARE_REGISTER(_di, types::WORD)
-DECLARE_REGISTER(_edi, types::DWORD)
-DECLARE_REGISTER(_rsi, types::QWORD)
-DECLARE_REGISTER(_si, types::WORD)
-DECLARE_REGISTER(_esi, types::DWORD)
-DECLARE_REGISTER(_rsp, types::QWORD)
-DECLARE_REGISTER(_sp, types::WORD)
-DECLARE_REGISTER(_esp, types::DWORD)
-DECLARE_REGISTER(_rbp, types::QWORD)
-DECLARE_REGISTER(_bp, types::WORD)
-DECLARE_REGISTER(_ebp, types::DWORD)
-DECLARE_REGISTER(_rip, types::QWORD)
-DECLARE_REGISTER(_ip, types::WORD)
-DECLARE_REGISTER(_eip, types::DWORD)
-DECLARE_REGISTER(_rcs, types::QWORD)
-DECLARE_REGISTER(_cs, types::WORD)
-DECLARE_REGISTER(_ecs, types::DWORD)
-DECLARE_REGISTER(_rds, types::QWORD)
-DECLARE_REGISTER(_ds, types::WORD)
-DECLARE_REGISTER(_eds, types::DWORD)
-DECLARE_REGISTER(_res, types::QWORD)
-DECLARE_REGISTER(_es, types::WORD)
-DECLARE_REGISTER(_ees, types::DWORD)
-DECLARE_REGISTER(_rfs, types::QWORD)
-DECLARE_REGISTER(_fs, types::WORD)
-DECLARE_REGISTER(_efs, types::DWORD)
-DECLARE_REGISTER(_rgs, types::QWORD)
-DECLARE_REGISTER(_gs, types::WORD)
-DECLARE_REGISTER(_egs, types::DWORD)
-DECLARE_REGISTER(_rss, types::QWORD)
-DECLARE_REGISTER(_ss, types::WORD)
-DECLARE_REGISTER(_ess, types::DWORD)
-DECLARE_REGISTER(_cf, types::BIT)
-DECLARE_REGISTER(_pf, types::BIT)
-DECLARE_REGISTER(_af, types::BIT)
-DECLARE_REGISTER(_zf, types::BIT)
-DECLARE_REGISTER(_sf, types::BIT)
-DECLARE_REGISTER(_tf, types::BIT)
-DECLARE_REGISTER(_if, types::BIT)
-DECLARE_REGISTER(_df, types::BIT)
-DECLARE_REGISTER(_of, types::BIT)
-DECLARE_REGISTER(_iopl, types::BIT)
-DECLARE_REGISTER(_nt, types::BIT)
-DECLARE_REGISTER(_rf, types::BIT)
-DECLARE_REGISTER(_vm, types::BIT)
-DECLARE_REGISTER(_ac, types::BIT)
-DECLARE_REGISTER(_vif, types::BIT)
-DECLARE_REGISTER(_vip, types::BIT)
-DECLARE_REGISTER(_id, types::BIT)
-DECLARE_REGISTER(_r8, types::QWORD)
-DECLARE_REGISTER(_r8d, types::DWORD)
-DECLARE_REGISTER(_r8w, types::WORD)
-DECLARE_REGISTER(_r8b, types::BYTE)
-DECLARE_REGISTER(_r8h, types::BYTE)
-DECLARE_REGISTER(_r9, types::QWORD)
-DECLARE_REGISTER(_r9d, types::DWORD)
-DECLARE_REGISTER(_r9w, types::WORD)
-DECLARE_REGISTER(_r9b, types::BYTE)
-DECLARE_REGISTER(_r9h, types::BYTE)
-DECLARE_REGISTER(_r10, types::QWORD)
-DECLARE_REGISTER(_r10d, types::DWORD)
-DECLARE_REGISTER(_r10w, types::WORD)
-DECLARE_REGISTER(_r10b, types::BYTE)
-DECLARE_REGISTER(_r10h, types::BYTE)
-DECLARE_REGISTER(_r11, types::QWORD)
-DECLARE_REGISTER(_r11d, types::DWORD)
-DECLARE_REGISTER(_r11w, types::WORD)
-DECLARE_REGISTER(_r11b, types::BYTE)
-DECLARE_REGISTER(_r11h, types::BYTE)
-DECLARE_REGISTER(_r12, types::QWORD)
-DECLARE_REGISTER(_r12d, types::DWORD)
-DECLARE_REGISTER(_r12w, types::WORD)
-DECLARE_REGISTER(_r12b, types::BYTE)
-DECLARE_REGISTER(_r12h, types::BYTE)
-DECLARE_REGISTER(_r13, types::QWORD)
-DECLARE_REGISTER(_r13d, types::DWORD)
-DECLARE_REGISTER(_r13w, types::WORD)
-DECLARE_REGISTER(_r13b, types::BYTE)
-DECLARE_REGISTER(_r13h, types::BYTE)
-DECLARE_REGISTER(_r14, types::QWORD)
-DECLARE_REGISTER(_r14d, types::DWORD)
-DECLARE_REGISTER(_r14w, types::WORD)
-DECLARE_REGISTER(_r14b, types::BYTE)
-DECLARE_REGISTER(_r14h, types::BYTE)
-DECLARE_REGISTER(_r15, types::QWORD)
-DECLARE_REGISTER(_r15d, types::DWORD)
-DECLARE_REGISTER(_r15w, types::WORD)
-DECLARE_REGISTER(_r15b, types::BYTE)
-DECLARE_REGISTER(_r15h, types::BYTE)
-DECLARE_REGISTER(_xmm0, types::XMM)
-DECLARE_REGISTER(_xmm1, types::XMM)
-DECLARE_REGISTER(_xmm2, types::XMM)
-DECLARE_REGISTER(_xmm3, types::XMM)
-DECLARE_REGISTER(_xmm4, types::XMM)
-DECLARE_REGISTER(_xmm5, types::XMM)
-DECLARE_REGISTER(_xmm6, types::XMM)
-DECLARE_REGISTER(_xmm7, types::XMM)
-
-const std::map<std::string, VisitableBase *> registers{
-    {"rax", CAST_TO_VISITABLE(reg_rax)},
-    {"al", CAST_TO_VISITABLE(reg_al)},
-    {"ah", CAST_TO_VISITABLE(reg_ah)},
-    {"ax", CAST_TO_VISITABLE(reg_ax)},
-    {"eax", CAST_TO_VISITABLE(reg_eax)},
-    {"rbx", CAST_TO_VISITABLE(reg_rbx)},
-    {"bl", CAST_TO_VISITABLE(reg_bl)},
-    {"bh", CAST_TO_VISITABLE(reg_bh)},
-    {"bx", CAST_TO_VISITABLE(reg_bx)},
-    {"ebx", CAST_TO_VISITABLE(reg_ebx)},
-    {"rcx", CAST_TO_VISITABLE(reg_rcx)},
-    {"cl", CAST_TO_VISITABLE(reg_cl)},
-    {"ch", CAST_TO_VISITABLE(reg_ch)},
-    {"cx", CAST_TO_VISITABLE(reg_cx)},
-    {"ecx", CAST_TO_VISITABLE(reg_ecx)},
-    {"rdx", CAST_TO_VISITABLE(reg_rdx)},
-    {"dl", CAST_TO_VISITABLE(reg_dl)},
-    {"dh", CAST_TO_VISITABLE(reg_dh)},
-    {"dx", CAST_TO_VISITABLE(reg_dx)},
-    {"edx", CAST_TO_VISITABLE(reg_edx)},
-    {"rdi", CAST_TO_VISITABLE(reg_rdi)},
-    {"di", CAST_TO_VISITABLE(reg_di)},
-    {"edi", CAST_TO_VISITABLE(reg_edi)},
-    {"rsi", CAST_TO_VISITABLE(reg_rsi)},
-    {"si", CAST_TO_VISITABLE(reg_si)},
-    {"esi", CAST_TO_VISITABLE(reg_esi)},
-    {"rsp", CAST_TO_VISITABLE(reg_rsp)},
-    {"sp", CAST_TO_VISITABLE(reg_sp)},
-    {"esp", CAST_TO_VISITABLE(reg_esp)},
-    {"rbp", CAST_TO_VISITABLE(reg_rbp)},
-    {"bp", CAST_TO_VISITABLE(reg_bp)},
-    {"ebp", CAST_TO_VISITABLE(reg_ebp)},
-    {"rip", CAST_TO_VISITABLE(reg_rip)},
-    {"ip", CAST_TO_VISITABLE(reg_ip)},
-    {"eip", CAST_TO_VISITABLE(reg_eip)},
-    {"rcs", CAST_TO_VISITABLE(reg_rcs)},
-    {"cs", CAST_TO_VISITABLE(reg_cs)},
-    {"ecs", CAST_TO_VISITABLE(reg_ecs)},
-    {"rds", CAST_TO_VISITABLE(reg_rds)},
-    {"ds", CAST_TO_VISITABLE(reg_ds)},
-    {"eds", CAST_TO_VISITABLE(reg_eds)},
-    {"res", CAST_TO_VISITABLE(reg_res)},
-    {"es", CAST_TO_VISITABLE(reg_es)},
-    {"ees", CAST_TO_VISITABLE(reg_ees)},
-    {"rfs", CAST_TO_VISITABLE(reg_rfs)},
-    {"fs", CAST_TO_VISITABLE(reg_fs)},
-    {"efs", CAST_TO_VISITABLE(reg_efs)},
-    {"rgs", CAST_TO_VISITABLE(reg_rgs)},
-    {"gs", CAST_TO_VISITABLE(reg_gs)},
-    {"egs", CAST_TO_VISITABLE(reg_egs)},
-    {"rss", CAST_TO_VISITABLE(reg_rss)},
-    {"ss", CAST_TO_VISITABLE(reg_ss)},
-    {"ess", CAST_TO_VISITABLE(reg_ess)},
-    {"cf", CAST_TO_VISITABLE(reg_cf)},
-    {"pf", CAST_TO_VISITABLE(reg_pf)},
-    {"af", CAST_TO_VISITABLE(reg_af)},
-    {"zf", CAST_TO_VISITABLE(reg_zf)},
-    {"sf", CAST_TO_VISITABLE(reg_sf)},
-    {"tf", CAST_TO_VISITABLE(reg_tf)},
-    {"if", CAST_TO_VISITABLE(reg_if)},
-    {"df", CAST_TO_VISITABLE(reg_df)},
-    {"of", CAST_TO_VISITABLE(reg_of)},
-    {"iopl", CAST_TO_VISITABLE(reg_iopl)},
-    {"nt", CAST_TO_VISITABLE(reg_nt)},
-    {"rf", CAST_TO_VISITABLE(reg_rf)},
-    {"vm", CAST_TO_VISITABLE(reg_vm)},
-    {"ac", CAST_TO_VISITABLE(reg_ac)},
-    {"vif", CAST_TO_VISITABLE(reg_vif)},
-    {"vip", CAST_TO_VISITABLE(reg_vip)},
-    {"id", CAST_TO_VISITABLE(reg_id)},
-    {"r8", CAST_TO_VISITABLE(reg_r8)},
-    {"r8d", CAST_TO_VISITABLE(reg_r8d)},
-    {"r8w", CAST_TO_VISITABLE(reg_r8w)},
-    {"r8b", CAST_TO_VISITABLE(reg_r8b)},
-    {"r8h", CAST_TO_VISITABLE(reg_r8h)},
-    {"r9", CAST_TO_VISITABLE(reg_r9)},
-    {"r9d", CAST_TO_VISITABLE(reg_r9d)},
-    {"r9w", CAST_TO_VISITABLE(reg_r9w)},
-    {"r9b", CAST_TO_VISITABLE(reg_r9b)},
-    {"r9h", CAST_TO_VISITABLE(reg_r9h)},
-    {"r10", CAST_TO_VISITABLE(reg_r10)},
-    {"r10d", CAST_TO_VISITABLE(reg_r10d)},
-    {"r10w", CAST_TO_VISITABLE(reg_r10w)},
-    {"r10b", CAST_TO_VISITABLE(reg_r10b)},
-    {"r10h", CAST_TO_VISITABLE(reg_r10h)},
-    {"r11", CAST_TO_VISITABLE(reg_r11)},
-    {"r11d", CAST_TO_VISITABLE(reg_r11d)},
-    {"r11w", CAST_TO_VISITABLE(reg_r11w)},
-    {"r11b", CAST_TO_VISITABLE(reg_r11b)},
-    {"r11h", CAST_TO_VISITABLE(reg_r11h)},
-    {"r12", CAST_TO_VISITABLE(reg_r12)},
-    {"r12d", CAST_TO_VISITABLE(reg_r12d)},
-    {"r12w", CAST_TO_VISITABLE(reg_r12w)},
-    {"r12b", CAST_TO_VISITABLE(reg_r12b)},
-    {"r12h", CAST_TO_VISITABLE(reg_r12h)},
-    {"r13", CAST_TO_VISITABLE(reg_r13)},
-    {"r13d", CAST_TO_VISITABLE(reg_r13d)},
-    {"r13w", CAST_TO_VISITABLE(reg_r13w)},
-    {"r13b", CAST_TO_VISITABLE(reg_r13b)},
-    {"r13h", CAST_TO_VISITABLE(reg_r13h)},
-    {"r14", CAST_TO_VISITABLE(reg_r14)},
-    {"r14d", CAST_TO_VISITABLE(reg_r14d)},
-    {"r14w", CAST_TO_VISITABLE(reg_r14w)},
-    {"r14b", CAST_TO_VISITABLE(reg_r14b)},
-    {"r14h", CAST_TO_VISITABLE(reg_r14h)},
-    {"r15", CAST_TO_VISITABLE(reg_r15)},
-    {"r15d", CAST_TO_VISITABLE(reg_r15d)},
-    {"r15w", CAST_TO_VISITABLE(reg_r15w)},
-    {"r15b", CAST_TO_VISITABLE(reg_r15b)},
-    {"r15h", CAST_TO_VISITABLE(reg_r15h)},
-    {"xmm0", CAST_TO_VISITABLE(reg_xmm0)},
-    {"xmm1", CAST_TO_VISITABLE(reg_xmm1)},
-    {"xmm2", CAST_TO_VISITABLE(reg_xmm2)},
-    {"xmm3", CAST_TO_VISITABLE(reg_xmm3)},
-    {"xmm4", CAST_TO_VISITABLE(reg_xmm4)},
-    {"xmm5", CAST_TO_VISITABLE(reg_xmm5)},
-    {"xmm6", CAST_TO_VISITABLE(reg_xmm6)},
-    {"xmm7", CAST_TO_VISITABLE(reg_xmm7)},
+ASM_REGISTER_TABLE(DECLARE_REGISTER)
+
+#undef DECLARE_REGISTER
+
+/**
+ * Registers indexed by RegisterId
+ */
+static VisitableBase *const register_symbols[register_count] = {
+#define REGISTER_SYMBOL(name, type, parent, offset) \
+    CAST_TO_VISITABLE(reg##name),
+    ASM_REGISTER_TABLE(REGISTER_SYMBOL)
+#undef REGISTER_SYMBOL
 };
+
+VisitableBase *get_register(RegisterId id) noexcept {
+  return register_symbols[(size_t) id];
+}
+
+RegisterId register_id(const VisitableBase *symbol) noexcept {
+  static const auto ids = [] {
+    std::unordered_map<const VisitableBase *, RegisterId> ids;
+    for (size_t id = 0; id < register_count; ++id)
+      ids.emplace(register_symbols[id], (RegisterId) id);
+    return ids;
+  }();
+  auto found = ids.find(symbol);
+  return found == ids.end() ? RegisterId::count : found->second;
+}
+
+const std::map<std::string, VisitableBase *> registers = [] {
+  std::map<std::string, VisitableBase *> registers;
+  for (size_t id = 0; id < register_count; ++id)
+    registers.emplace(register_info[id].name, register_symbols[id]);
+  return registers;
+}();
 }  // namespace symbol_table
 
 namespace symbol_table {
@@ -300,20 +86,125 @@ const {
     return "(" + lhs_name + ") " + op + " (" + rhs_name + ")";
   return lhs_name + op + rhs_name;
 }
+
+// ~~~~~ Immidiate
+Immidiate::Immidiate(std::string_view value)
+    : Symbol(lazy_name_t()) {
+  format(value);
+  if (!numeric)
+    return;
+  auto hex = value.substr(prefixed ? 2 : 0);
+  auto result = std::from_chars(hex.data(), hex.data() + hex.size(), number, 16);
+  numeric = result.ec == std::errc() && result.ptr == hex.data() + hex.size();
+  if (!numeric)
+    text = std::string(value);
+}
+
+Immidiate::Immidiate(std::string_view value, uint64_t number)
+    : Symbol(lazy_name_t()), number(number) {
+  format(value);
+}
+
+Immidiate::Immidiate(uint64_t number, uint8_t width)
+    : Symbol(lazy_name_t()), number(number), width(width),
+      prefixed(true), numeric(true) {
+  if (width < 64)
+    this->number &= (1ull << width) - 1;
+  do {
+    ++digits;
+  } while (digits < 16 && (this->number >> (digits * 4)) != 0);
+}
+
+int64_t Immidiate::getSigned() const {
+  if (width >= 64)
+    return (int64_t) number;
+  uint64_t sign = 1ull << (width - 1);
+  return (int64_t) ((number ^ sign) - sign);
+}
+
+void Immidiate::format(std::string_view value) {
+  prefixed = value.size() > 2 && value[0] == '0' && value[1] == 'x';
+  auto hex = value.substr(prefixed ? 2 : 0);
+  bool has_lower = false, has_upper = false, is_hex = !hex.empty();
+  for (char c : hex) {
+    has_lower = has_lower || (c >= 'a' && c <= 'f');
+    has_upper = has_upper || (c >= 'A' && c <= 'F');
+    is_hex = is_hex && ((c >= '0' && c <= '9')
+        || (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F'));
+  }
+  // more digits than 64 bits (or mixed case) could not be rendered back
+  numeric = is_hex && hex.size() <= 16 && !(has_lower && has_upper);
+  if (!numeric) {
+    text = std::string(value);
+    return;
+  }
+  upper = has_upper;
+  digits = (uint8_t) hex.size();
+  width = digits <= 2 ? 8 : digits <= 4 ? 16 : digits <= 8 ? 32 : 64;
+}
+
+std::string Immidiate::renderName() const {
+  if (!numeric)
+    return text;
+  const char *alphabet = upper ? "0123456789ABCDEF" : "0123456789abcdef";
+  std::string name(prefixed ? "0x" : "");
+  for (int digit = digits - 1; digit >= 0; --digit)
+    name += alphabet[(number >> (digit * 4)) & 0xf];
+  return name;
+}
+// ~~~~~ Immidiate
 }  // namespace symbol_table
 
 
-static auto empty_functions = instruction_parser::sym_map_t::type();
+instruction_parser::sym_t::ptr::shared
+instruction_parser::AddressLookup::find(bfd_vma address) const {
+  for (auto map : {base, symbols})
+    if (map) {
+      auto ite = map->find(address);
+      if (ite != map->end())
+        return ite->second;
+    }
+  return nullptr;
+}
 
 instruction_parser::sym_t::rx::shared_obs instruction_parser:: getArgs
-    (instruction_parser::sym_map_t::c::ref functions)
+    (instruction_parser::lookup_t::c::ref functions,
+     const instruction_parser::arena_t::ptr::shared &arena)
 const throw(std::runtime_error) {
+  return getArgs(functions, std::make_shared<pool_t::type>(arena));
+}
+
+instruction_parser::sym_t::rx::shared_obs instruction_parser:: getArgs
+    (instruction_parser::lookup_t::c::ref functions,
+     const instruction_parser::pool_t::ptr::shared &pool)
+const throw(std::runtime_error) {
+  if (!pool)
+    return getArgs(functions, std::make_shared<pool_t::type>());
+  if (pieceCount() != no_pieces) {
+    // functions can be temporary, so arguments are parsed right away
+    auto parse_pieces = [&](pool_t::ref pool) {
+      sym_t::vector::shared args;
+      for (size_t i = 1; i < pieceCount(); ++i) {
+        args.push_back(handle_expression(piece(i), functions, pool));
+        assert_ex((bool) args.back(), "failed to create symbol/expression");
+      }
+      return args;
+    };
+    auto text = operandsText();
+    auto &memo = pool->getMemo();
+    return rxcpp::sources::iterate(
+        memo && !text.empty()
+        ? memo->get(text, functions, parse_pieces)
+        : parse_pieces(*pool)
+    );
+  }
+
   return parse()
       .skip(1)
-      .map([&](
+      .map([this, functions, pool](
           const std::string &arg
       ) -> sym_t::ptr::shared {
-        return handle_expression(arg, functions);
+        return handle_expression(arg, functions, *pool);
       })
 #if !defined(NASSERT_EX) || NASSERT_EX == 0
       .filter([](
@@ -327,7 +218,8 @@ const throw(std::runtime_error) {
 }
 
 instruction_parser::sym_t::ptr::shared    instruction_parser::create_dereference
-    (std::string size, std::string expr, sym_map_t::c::ref functions)
+    (std::string_view size, std::string_view expr, lookup_t::c::ref functions,
+     pool_t::ref pool)
 const throw(std::runtime_error) {
   using namespace symbol_table::types;
 
@@ -339,8 +231,8 @@ const throw(std::runtime_error) {
 
 #define IMPLEMENT_TYPE_HANDLER(type) do { \
   if (size == type::size_trait::name) { \
-    if (auto rhs = handle_expression(expr, functions)) { \
-      return std::make_shared<type>("*", rhs); \
+    if (auto rhs = handle_expression(expr, functions, pool)) { \
+      return pool.unary<type>("*", rhs); \
     } \
   } \
 } while (false)
@@ -359,63 +251,165 @@ const throw(std::runtime_error) {
 }
 
 instruction_parser::sym_t::ptr::shared    instruction_parser::create_operation
-    (std::string lhs, std::string op, std::string rhs, sym_map_t::c::ref functions)
+    (std::string_view lhs, char op, std::string_view rhs, lookup_t::c::ref functions,
+     pool_t::ref pool)
 const throw(std::runtime_error) {
-  if (auto lhs_expr = handle_expression(lhs, functions))
-    if (auto rhs_expr = handle_expression(rhs, functions))
-      return std::make_shared<symbol_table::Temporary>(
-          lhs_expr, op, rhs_expr
+  if (auto lhs_expr = handle_expression(lhs, functions, pool))
+    if (auto rhs_expr = handle_expression(rhs, functions, pool))
+      return pool.binary<symbol_table::Temporary>(
+          lhs_expr, std::string_view(&op, 1), rhs_expr
       );
   return nullptr;
 }
 
 instruction_parser::sym_t::ptr::shared    instruction_parser::create_imm
-    (std::string value, sym_map_t::c::ref functions)
+    (std::string_view value, bfd_vma number, lookup_t::c::ref functions,
+     pool_t::ref pool)
 const throw() {
-  return std::make_shared<symbol_table::Immidiate>(value);
+  return pool.leaf<symbol_table::Immidiate>(value, (uint64_t) number);
 }
 
+// ~~~~~ Operand scanner
+namespace {
 /**
- * @brief Converts string to virtual memory address (aka from hex to number)
- * @param input is raw text like 0x000008 or just plain 42
- * @return input at number (not hexa string)
+ * Sizes that can be dereferenced (as in "<SIZE> PTR [<expr>]")
  */
-bfd_vma str_to_vma(std::string input) {
-  std::stringstream ss;
-  bfd_vma result;
-  static_cast<std::stringstream &>(
-      ss << std::hex << input
-  ) >> std::hex >> result;
-  return result;
+const std::string_view dereference_sizes[] = {
+    "XMMWORD", "BYTE", "WORD", "DWORD", "QWORD"
+};
+
+bool is_hex(char c) {
+  return (c >= '0' && c <= '9')
+      || (c >= 'a' && c <= 'f')
+      || (c >= 'A' && c <= 'F');
 }
 
+bool is_word(char c) {
+  return (c >= '0' && c <= '9')
+      || (c >= 'a' && c <= 'z')
+      || (c >= 'A' && c <= 'Z')
+      || c == '_';
+}
+
+/**
+ * Operators and dereferences never span more lines
+ */
+bool is_line_break(char c) {
+  return c == '\n' || c == '\r';
+}
+
+/**
+ * @brief Scans hexadecimal number (0x1f, 00401000, ...)
+ * @param expr is whole operand
+ * @param value is set to value of number, saturated at bfd_vma max
+ * @return true if whole operand is number
+ */
+bool scan_number(std::string_view expr, bfd_vma &value) {
+  if (expr.size() > 2 && expr[0] == '0' && expr[1] == 'x')
+    expr.remove_prefix(2);
+  if (expr.empty())
+    return false;
+
+  value = 0;
+  bool overflow = false;
+  for (char c : expr) {
+    if (!is_hex(c))
+      return false;
+    bfd_vma digit = c <= '9' ? c - '0' : (c | 0x20) - 'a' + 10;
+    overflow = overflow || value > (((bfd_vma) -1) >> 4);
+    value = (value << 4) | digit;
+  }
+  if (overflow)
+    value = (bfd_vma) -1;
+  return true;
+}
+
+/**
+ * @brief Scans "<SIZE> PTR [<segment>:]?[<expr>]"
+ * @param expr is whole operand
+ * @param size is set to <SIZE>
+ * @param inner is set to everything between first '[' and last ']'
+ * @return true if whole operand is dereference
+ */
+bool scan_dereference(
+    std::string_view expr,
+    std::string_view &size,
+    std::string_view &inner
+) {
+  static const std::string_view ptr = " PTR ";
+  auto found = std::find_if(
+      std::begin(dereference_sizes), std::end(dereference_sizes),
+      [expr](std::string_view name) {
+        return expr.compare(0, name.size(), name) == 0
+            && expr.compare(name.size(), ptr.size(), ptr) == 0;
+      }
+  );
+  if (found == std::end(dereference_sizes))
+    return false;
+  size = *found;
+
+  auto rest = expr.substr(size.size() + ptr.size());
+  size_t segment = 0;
+  while (segment < rest.size() && is_word(rest[segment]))
+    ++segment;
+  if (segment != 0) {
+    if (segment == rest.size() || rest[segment] != ':')
+      return false;
+    rest.remove_prefix(segment + 1);
+  }
+
+  if (rest.size() < 2 || rest.front() != '[' || rest.back() != ']')
+    return false;
+  inner = rest.substr(1, rest.size() - 2);
+  return std::none_of(inner.begin(), inner.end(), is_line_break);
+}
+
+/**
+ * @brief Finds last binary operator with operands on both sides
+ * @param expr is whole operand
+ * @param operators are characters to look for
+ * @return position of operator or npos
+ */
+size_t find_operator(std::string_view expr, std::string_view operators) {
+  if (expr.size() < 3
+      || std::any_of(expr.begin(), expr.end(), is_line_break))
+    return std::string_view::npos;
+  for (size_t i = expr.size() - 2; i > 0; --i)
+    if (operators.find(expr[i]) != std::string_view::npos)
+      return i;
+  return std::string_view::npos;
+}
+}  // namespace
+// ~~~~~ Operand scanner
+
 instruction_parser::sym_t::ptr::shared    instruction_parser::handle_expression
-    (std::string expr, sym_map_t::c::ref functions)
+    (std::string_view expr, lookup_t::c::ref functions,
+     pool_t::ref pool)
 const throw(std::runtime_error) {
-  std::smatch result;
+  bfd_vma value;
+  bool is_number = scan_number(expr, value);
   { // if (possible) parameter is function
-    if (std::regex_match(expr, result, address)) {
+    if (is_number) {
       // find function by address
-      auto func_symbol = functions.find(str_to_vma(result.str(1)));
-      if (func_symbol != functions.cend()) {
-        return func_symbol->second;
+      if (auto func_symbol = functions.find(value)) {
+        return func_symbol;
       }
     }
   }
 
   { // if (possible) parameter is register
-    auto reg_symbol = symbol_table::registers.find(expr);
-    if (reg_symbol != symbol_table::registers.end()) {
+    auto reg_id = symbol_table::find_register(expr);
+    if (reg_id != symbol_table::RegisterId::count) {
       return sym_t::ptr::shared(
-          reg_symbol->second,
+          symbol_table::get_register(reg_id),
           symbol_table::register_deleter
       );
     }
   }
 
   { // is it value?
-    if (std::regex_match(expr, result, number)) {
-      return create_imm(result.str(1), functions);
+    if (is_number) {
+      return create_imm(expr, value, functions, pool);
     }
   }
 
@@ -423,28 +417,34 @@ const throw(std::runtime_error) {
   //  1. dereference
   //  2. multiplication
   //  3. add/subtraction
+  // binary operators are split at the last occurrence (left associative)
 
   { // it is dereference?
-    if (std::regex_match(expr, result, dereference)) {
-      return create_dereference(
-          result.str(1), result.str(2), functions
-      );
+    std::string_view size, inner;
+    if (scan_dereference(expr, size, inner)) {
+      return create_dereference(size, inner, functions, pool);
     }
   }
 
   { // is it multiplication operation?
-    if (std::regex_match(expr, result, multiplication)) {
-      return create_operation(result.str(1), result.str(2), result.str(3), functions);
+    auto op = find_operator(expr, "*");
+    if (op != std::string_view::npos) {
+      return create_operation(
+          expr.substr(0, op), expr[op], expr.substr(op + 1), functions, pool
+      );
     }
   }
 
   { // is it add or subtract operation?
-    if (std::regex_match(expr, result, add_or_substract)) {
-      return create_operation(result.str(1), result.str(2), result.str(3), functions);
+    auto op = find_operator(expr, "+-");
+    if (op != std::string_view::npos) {
+      return create_operation(
+          expr.substr(0, op), expr[op], expr.substr(op + 1), functions, pool
+      );
     }
   }
 
   // unknown symbol or expression
-  return std::make_shared<symbol_table::Symbol>(expr);
+  return pool.leaf<symbol_table::Symbol>(expr);
 }
 //
@@ -3,17 +3,20 @@
 //
 
 #include <algorithm>
+#include <charconv>
 #include <dis-asm.h>
 #include <string.h>
 #include <stdarg.h>
 #include <stdlib.h>
-#include <sstream>
+#include <string_view>
+#include <list>
 #include <map>
 #include <iostream>
 #include <set>
 
 #include "../../include/befa/utils/assert.hpp"
 #include "../../include/befa.hpp"
+#include "../../include/befa/llvm/function_cache.hpp"
 
 struct BasicBlockDecoder;
 
@@ -44,9 +47,15 @@ uint64_t match_jump(std::string instr) {
   std::string addr_str;
   pcrecpp::StringPiece input(instr);
   if (regex.FindAndConsume(&input, &addr_str)) {
-    std::stringstream ss;
-    ss << std::hex << addr_str;
-    if (ss >> addr)
+    // as std::hex stream would: skip leading spaces and 0x
+    std::string_view hex(addr_str);
+    hex.remove_prefix(
+        std::min(hex.find_first_not_of(" \t\n\r\f\v"), hex.size())
+    );
+    if (hex.size() > 2 && hex[0] == '0' && (hex[1] == 'x' || hex[1] == 'X'))
+      hex.remove_prefix(2);
+    auto result = std::from_chars(hex.data(), hex.data() + hex.size(), addr, 16);
+    if (result.ec == std::errc())
       return addr;
     else
       return (uint64_t) -2;
@@ -54,10 +63,22 @@ uint64_t match_jump(std::string instr) {
   return (uint64_t) -1;
 }
 
+int ffnull(void *, const char *, ...);
+
+/**
+ * Basic blocks and section contents of symbol decoded in streaming mode,
+ * owned by its instructions (@see ExecutableFile::setMemoryBudget)
+ */
+struct StreamedSymbol {
+  ExecutableFile::bb_t::vector::shared blocks;
+  std::shared_ptr<const uint8_t[]> contents;
+};
+
 struct SymbolDataLoader {
   using sym_t = ExecutableFile::sym_t;
   using bb_t = ExecutableFile::bb_t;
   using inst_t = ExecutableFile::inst_t;
+  using cache_t = type_traits::container<llvm::FunctionCache>;
 
   using ffile_t = type_traits::container<disassembler_impl::ffile>;
 
@@ -71,15 +92,16 @@ struct SymbolDataLoader {
       disassemble_info d_info,
       bfd *_fd,
       ffile_t::ptr::weak f,
-      bfd_vma sym_size
+      bfd_vma sym_size,
+      cache_t::ptr::shared cache,
+      const std::shared_ptr<const void> &owner,
+      ExecutableFile::visitor_t &visitor
             ) {
     { // file related work
       auto f_lock = ptr_lock(f);
       auto sym_lock = ptr_lock(ptr);
       auto sec_lock = ptr_lock(sym_lock->getParent());
 
-      f_lock->reset();
-
       disassembler_ftype _dis_asm = disassembler(_fd);
       assert_ex(
           _dis_asm,
@@ -87,72 +109,282 @@ struct SymbolDataLoader {
       );
 
       bfd_vma sym_address = sym_lock->getAddress();
-      int i_size = _dis_asm(sym_address, &d_info);
-      int offset = 0;
-      int max_offset = (int) sym_size;
-
-      std::vector<std::tuple<array_view<uint8_t>, std::string, uint64_t>>
-          instructions;
-      std::set<uint64_t> basic_block_addresses{sym_address};
-
-      // clear fake file, load instruction, ...
-      for (uint64_t i_address = sym_address + offset;
-           (i_size > 0) && (offset < max_offset);
-           f_lock->reset(), i_size = _dis_asm(
-               i_address = sym_address + offset,
-               &d_info
-           )
-          ) {
-        uint64_t address;
-        if ((address = match_jump(f_lock->buffer)) != (uint64_t) -1) {
-          basic_block_addresses.emplace(address);
-          basic_block_addresses.emplace(i_address + i_size);
+      const uint8_t *sym_bytes = d_info.buffer + (sym_address - d_info.buffer_vma);
+      cache_t::info::type::Hasher hasher = machine_hasher(d_info);
+      basic_block_addresses.emplace(sym_address);
+
+      if (cache) {
+        // cheap pass (nothing is printed) just to find out the key
+        cache_t::info::type::hash_t hash = probe(
+            _dis_asm, d_info, sym_address, sym_bytes, sym_size
+        );
+        auto entry = cache->find(hash);
+        if (entry && !entry->instructions.empty()) {
+          replay(*entry, _dis_asm, d_info, *f_lock, sym_address, sym_bytes);
+        } else {
+          cache_t::info::type::Entry recorded;
+          decode(
+              _dis_asm, d_info, *f_lock, sym_address, sym_bytes, sym_size,
+              hasher, &recorded
+          );
+          cache->insert(hash, std::move(recorded));
         }
-        // create instruction, and pass it into subj
-        instructions.emplace_back(std::make_tuple(
-            array_view<uint8_t>(d_info.buffer + offset, i_size),
-            f_lock->buffer,
-            i_address
-        ));
-        offset += i_size;
+        sym_lock->setContentHash(hash);
+      } else {
+        decode(
+            _dis_asm, d_info, *f_lock, sym_address, sym_bytes, sym_size,
+            hasher, nullptr
+        );
+        sym_lock->setContentHash(hasher.digest());
       }
+
       // erase -1 (which is 0xFFFFFF)
       auto bba_begin = basic_block_addresses.begin();
+      bb_t::info::type *block = nullptr;
 
+      visitor.symbolBegin(*sym_lock);
       for (auto &instr : instructions) {
+        // borders outside of symbol (or inside of instruction) are skipped
+        while (bba_begin != basic_block_addresses.end() &&
+            *bba_begin < std::get<2>(instr))
+          ++bba_begin;
         // if instruction has a border address, basic block is created
         if (bba_begin != basic_block_addresses.end() &&
             std::get<2>(instr) == *bba_begin) {
+          if (block)
+            visitor.blockEnd(*block);
           basic_block_buffer.emplace_back(
               std::make_shared<bb_t::info::type>(*bba_begin, ptr)
           );
+          block = basic_block_buffer.back().get();
+          visitor.blockBegin(*block);
           ++bba_begin;
         }
         assert_ex(
             !basic_block_buffer.empty(),
             "basic_block_buffer cannot be empty"
         );
-        instr_subj.get_subscriber()
-                  .on_next(inst_t::info::type(
-                      std::get<0>(instr), basic_block_buffer.back(),
-                      std::get<1>(instr), std::get<2>(instr)
-                  ));
+        inst_t::info::type instruction(
+            std::get<0>(instr), basic_block_buffer.back(),
+            std::get<1>(instr), std::get<2>(instr), owner
+        );
+        visitor.instruction(instruction);
+        instr_subj.get_subscriber().on_next(instruction);
       }
+      if (block)
+        visitor.blockEnd(*block);
+      visitor.symbolEnd(*sym_lock);
     }
   }
 
  private:
+  /**
+   * @return hasher seeded with instruction set of binary
+   */
+  static cache_t::info::type::Hasher machine_hasher(
+      const disassemble_info &d_info
+  ) {
+    return cache_t::info::type::Hasher(
+        (uint32_t) d_info.arch, (uint64_t) d_info.mach,
+        d_info.disassembler_options ? d_info.disassembler_options : ""
+    );
+  }
+
+  /**
+   * Adds decoded instruction, jumps are creating basic block borders
+   */
+  void append(
+      const uint8_t *bytes,
+      int i_size,
+      const std::string &decoded,
+      uint64_t i_address,
+      uint64_t jump
+             ) {
+    if (jump != (uint64_t) -1) {
+      basic_block_addresses.emplace(jump);
+      basic_block_addresses.emplace(i_address + i_size);
+    }
+    // create instruction, and pass it into subj
+    instructions.emplace_back(std::make_tuple(
+        array_view<uint8_t>((uint8_t *) bytes, i_size),
+        decoded,
+        i_address
+    ));
+  }
+
+  /**
+   * Decodes whole symbol
+   * @param record if not null, decoded instructions are stored here
+   */
+  void decode(
+      disassembler_ftype _dis_asm,
+      disassemble_info &d_info,
+      disassembler_impl::ffile &file,
+      bfd_vma sym_address,
+      const uint8_t *sym_bytes,
+      bfd_vma sym_size,
+      cache_t::info::type::Hasher &hasher,
+      cache_t::info::type::Entry *record
+             ) {
+    int offset = 0;
+    int max_offset = (int) sym_size;
+
+    file.reset();
+    int i_size = _dis_asm(sym_address, &d_info);
+
+    // clear fake file, load instruction, ...
+    for (uint64_t i_address = sym_address + offset;
+         (i_size > 0) && (offset < max_offset);
+         file.reset(), i_size = _dis_asm(
+             i_address = sym_address + offset,
+             &d_info
+         )
+        ) {
+      uint64_t jump = match_jump(file.buffer);
+      hasher.add(
+          sym_bytes + offset, (size_t) i_size, file.has_address, i_address,
+          file.address
+      );
+      if (record)
+        record->instructions.push_back({
+            (uint32_t) offset, (uint32_t) i_size, file.has_address, false,
+            // relocatable ones are decoded every time
+            file.has_address ? (uint64_t) -1 : jump,
+            file.has_address ? std::string() : file.buffer
+        });
+      append(sym_bytes + offset, i_size, file.buffer, i_address, jump);
+      offset += i_size;
+    }
+  }
+
+  /**
+   * Walks symbol like decode does, but nothing is printed
+   * @return hash of symbol
+   */
+  cache_t::info::type::hash_t probe(
+      disassembler_ftype _dis_asm,
+      disassemble_info d_info,
+      bfd_vma sym_address,
+      const uint8_t *sym_bytes,
+      bfd_vma sym_size
+                                  ) {
+    disassembler_impl::ffile file;
+    d_info.stream = &file;
+    d_info.fprintf_func = (fprintf_ftype) ffnull;
+
+    cache_t::info::type::Hasher hasher = machine_hasher(d_info);
+    int offset = 0;
+    int max_offset = (int) sym_size;
+    for (int i_size = _dis_asm(sym_address, &d_info);
+         (i_size > 0) && (offset < max_offset);
+         file.reset(), i_size = _dis_asm(sym_address + offset, &d_info)) {
+      hasher.add(
+          sym_bytes + offset, (size_t) i_size, file.has_address,
+          sym_address + offset, file.address
+      );
+      offset += i_size;
+    }
+    return hasher.digest();
+  }
+
+  /**
+   * Creates instructions from cache, instructions that depends on
+   * their address are decoded again
+   */
+  void replay(
+      const cache_t::info::type::Entry &entry,
+      disassembler_ftype _dis_asm,
+      disassemble_info &d_info,
+      disassembler_impl::ffile &file,
+      bfd_vma sym_address,
+      const uint8_t *sym_bytes
+             ) {
+    for (auto &cached : entry.instructions) {
+      uint64_t i_address = sym_address + cached.offset;
+      if (cached.relocatable) {
+        file.reset();
+        _dis_asm(i_address, &d_info);
+        append(
+            sym_bytes + cached.offset, cached.size, file.buffer, i_address,
+            match_jump(file.buffer)
+        );
+      } else {
+        append(
+            sym_bytes + cached.offset, cached.size, cached.decoded, i_address,
+            cached.jump
+        );
+      }
+    }
+  }
+
   sym_t::ptr::weak ptr;
+
+  std::vector<std::tuple<array_view<uint8_t>, std::string, uint64_t>>
+      instructions;
+
+  std::set<uint64_t> basic_block_addresses;
 };
 
 int ffprintf(struct disassembler_impl::ffile *f, const char *format, ...);
 
+void ffprint_address(bfd_vma address, struct disassemble_info *info);
+
 disassemble_info create_disassemble_info(bfd *_fd, disassembler_impl::ffile *f);
 
 void ExecutableFile::runDisassembler() {
+  visitor_t visitor;
+  runDisassembler(visitor);
+}
+
+void ExecutableFile::runDisassembler(visitor_t &visitor) {
   auto d_info = create_disassemble_info(_fd, fake_file.get());
 
   auto sym_table = getSymbolTable();
+
+  // sections are read in background, in the same order they are decoded
+  // (read-ahead has its own share of memory budget, the rest is for
+  // sections held by disassembler)
+  size_t prefetch_share = memory_budget
+                          ? std::min(prefetch_budget, memory_budget / 2)
+                          : prefetch_budget;
+  size_t section_budget = memory_budget ? memory_budget - prefetch_share : 0;
+  befa::SectionPrefetcher prefetcher(
+      _fd, prefetch_share, memory_budget != 0
+  );
+  for_each(sym_table, [&](auto &sym_ite) {
+    sym_t::ptr::shared sym_lock = ptr_lock(*sym_ite);
+    if (sym_lock->hasFlags(BSF_FUNCTION))
+      prefetcher.schedule(ptr_lock(sym_lock->getParent())->getOrigin());
+  });
+  prefetcher.start();
+
+  // every section is loaded only once and shared by all of its symbols
+  // (in streaming mode least recently used ones are evicted)
+  std::map<const asection *, std::shared_ptr<uint8_t[]>> section_contents;
+  std::list<const asection *> section_usage;
+  size_t section_bytes = 0;
+  peak_section_bytes = 0;
+  function_records.clear();
+  const sec_t::info::type *current_section = nullptr;
+
+  auto evict_sections = [&](size_t required) {
+    while (!section_usage.empty()
+        && section_bytes + required > section_budget) {
+      const asection *evicted = section_usage.front();
+      section_usage.pop_front();
+      uint8_t *buffer = section_contents[evicted].get();
+      section_contents.erase(evicted);
+      section_bytes -= bfd_section_size(_fd, evicted);
+      // instructions still held by subscribers keep their own reference
+      shared_buffer.erase(std::find_if(
+          shared_buffer.begin(), shared_buffer.end(),
+          [buffer](const std::shared_ptr<uint8_t[]> &stored) {
+            return stored.get() == buffer;
+          }
+      ));
+    }
+  };
+
   for_each(sym_table, [&](auto &sym_ite) {
     sym_t::ptr::weak sym = *sym_ite;
     sym_t::ptr::shared sym_lock = ptr_lock(sym);
@@ -162,6 +394,11 @@ void ExecutableFile::runDisassembler() {
       return;
 
     sec_t::ptr::shared section_lock = ptr_lock(sym_lock->getParent());
+    if (current_section != section_lock.get()) {
+      if (current_section)
+        visitor.sectionEnd(*current_section);
+      visitor.sectionBegin(*(current_section = section_lock.get()));
+    }
 
     sym_t::vector::weak::const_iterator closest_ite = std::find_if(
         sym_ite, sym_table.cend(),
@@ -179,30 +416,86 @@ void ExecutableFile::runDisassembler() {
     d_info.buffer_vma = section_lock->getAddress(_fd);
     d_info.buffer_length = (unsigned int) section_lock->getSize(_fd);
 
-    // create shared buffer for section (user of this will get weak_ptr, so lifetime is the same as this file)
-    auto memory = new uint8_t[d_info.buffer_length];
-    assert_ex(memory, "not enough memory");
-    shared_buffer.emplace_back(memory);
-    d_info.buffer = memory;
+    // shared buffer for section (user of this will get weak_ptr, so lifetime is the same as this file)
+    const asection *origin = section_lock->getOrigin();
+    auto contents = section_contents.find(origin);
+    if (contents == section_contents.end()) {
+      if (memory_budget)
+        evict_sections(d_info.buffer_length);
+      section_bytes += d_info.buffer_length;
+      peak_section_bytes = std::max(peak_section_bytes, section_bytes);
+      // evicted section is read again (synchronously)
+      shared_buffer.emplace_back(prefetcher.take(origin));
+      contents = section_contents.emplace(
+          origin, shared_buffer.back()
+      ).first;
+    }
+    if (memory_budget) {
+      section_usage.remove(origin);
+      section_usage.push_back(origin);
+    }
+    d_info.buffer = contents->second.get();
 
-    // loads content into shared data
-    bfd_get_section_contents(
-        _fd, (asection *) section_lock->getOrigin(),
-        d_info.buffer, 0, d_info.buffer_length
-    );
+    // in streaming mode instructions own what is released here
+    std::shared_ptr<StreamedSymbol> streamed;
+    if (memory_budget)
+      streamed = std::make_shared<StreamedSymbol>(
+          StreamedSymbol{{}, contents->second}
+      );
 
     // decode basic blocks
+    size_t basic_blocks = basic_block_buffer.size();
     SymbolDataLoader(sym).fetch(
-        assembly_subject, basic_block_buffer, d_info, _fd, fake_file, sym_size
+        assembly_subject, basic_block_buffer, d_info, _fd, fake_file, sym_size,
+        function_cache, streamed, visitor
     );
+    if (streamed) {
+      streamed->blocks.assign(
+          basic_block_buffer.begin() + basic_blocks, basic_block_buffer.end()
+      );
+      basic_block_buffer.erase(
+          basic_block_buffer.begin() + basic_blocks, basic_block_buffer.end()
+      );
+    }
+    function_records.push_back({
+        sym_lock->getName(), sym_lock->getAddress(), sym_size,
+        sym_lock->getContentHash()
+    });
   });
+  if (current_section)
+    visitor.sectionEnd(*current_section);
+  // bytes read ahead are not counted into section_bytes until taken
+  peak_section_bytes += prefetcher.peak();
+}
+
+befa::AnalysisDiff ExecutableFile::runIncremental(
+    const befa::Analysis &previous
+) {
+  function_cache = previous.cache
+                   ? previous.cache
+                   : std::make_shared<llvm::FunctionCache>();
+  runDisassembler();
+  return befa::AnalysisDiff(previous, getAnalysis());
 }
 
-disassembler_impl::ffile::ffile() : pos(0) {}
+disassembler_impl::ffile::ffile() : pos(0), has_address(false), address(0) {}
 
 void disassembler_impl::ffile::reset() {
   pos = 0;
   buffer.clear();
+  has_address = false;
+  address = 0;
+}
+
+int ffnull(void *, const char *, ...) {
+  return 0;
+}
+
+void ffprint_address(bfd_vma address, struct disassemble_info *info) {
+  // instruction is relocation-sensitive (see llvm::FunctionCache)
+  ((disassembler_impl::ffile *) info->stream)->has_address = true;
+  ((disassembler_impl::ffile *) info->stream)->address = address;
+  generic_print_address(address, info);
 }
 
 int ffprintf(
@@ -237,6 +530,7 @@ disassemble_info create_disassemble_info(
                                         ) {
   disassemble_info ret;
   init_disassemble_info(&ret, f, (fprintf_ftype) ffprintf);
+  ret.print_address_func = ffprint_address;
 
   // some bfd settings
   ret.flavour = bfd_get_flavour(_fd);
@@ -132,6 +132,11 @@ ExecutableFile::ExecutableFile(ExecutableFile &&rhs)
 //      llvm_subj(std::move(rhs.llvm_subj)),
       section_buffer(std::move(rhs.section_buffer)),
       symbol_buffer(std::move(rhs.symbol_buffer)),
+      prefetch_budget(rhs.prefetch_budget),
+      memory_budget(rhs.memory_budget),
+      peak_section_bytes(rhs.peak_section_bytes),
+      function_cache(std::move(rhs.function_cache)),
+      function_records(std::move(rhs.function_records)),
       is_valid(std::move(rhs.is_valid)),
       sections_sorted(std::move(rhs.sections_sorted)),
       symbols_sorted(std::move(rhs.symbols_sorted)) {
@@ -144,6 +149,11 @@ ExecutableFile &ExecutableFile::operator=(ExecutableFile &&rhs) {
 //  llvm_subj = std::move(rhs.llvm_subj);
   section_buffer = std::move(rhs.section_buffer);
   symbol_buffer = std::move(rhs.symbol_buffer);
+  prefetch_budget = rhs.prefetch_budget;
+  memory_budget = rhs.memory_budget;
+  peak_section_bytes = rhs.peak_section_bytes;
+  function_cache = std::move(rhs.function_cache);
+  function_records = std::move(rhs.function_records);
   is_valid = std::move(rhs.is_valid);
   sections_sorted = std::move(rhs.sections_sorted);
   symbols_sorted = std::move(rhs.symbols_sorted);
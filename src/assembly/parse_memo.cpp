@@ -0,0 +1,118 @@
+//
+// Created by miro on 10/18/26.
+//
+
+#include <algorithm>
+
+#include "../../include/befa/assembly/parse_memo.hpp"
+
+namespace befa {
+
+namespace {
+/**
+ * Collects numbers of operand tree (every number has been looked up
+ * in functions by parser)
+ *
+ * @return false if tree contains function
+ */
+bool collect_numbers(
+    const symbol_table::VisitableBase *node,
+    std::vector<bfd_vma> &numbers
+) {
+  if (!node)
+    return true;
+  if (dynamic_cast<const symbol_table::Function *>(node))
+    return false;
+  if (auto immidiate = dynamic_cast<const symbol_table::Immidiate *>(node)) {
+    // too long numbers are saturated by parser
+    numbers.push_back(
+        immidiate->isNumeric() ? immidiate->getUnsigned() : (bfd_vma) -1
+    );
+    return true;
+  }
+  if (auto temporary = dynamic_cast<const symbol_table::Temporary *>(node))
+    return collect_numbers(temporary->getLeft().get(), numbers)
+        && collect_numbers(temporary->getRight().get(), numbers);
+  return true;
+}
+
+/**
+ * Names are rendered on first use, so they are rendered before nodes are
+ * visible to other threads
+ */
+void render_names(const ParseMemo::sym_t::vector::shared &args) {
+  for (auto &arg : args)
+    if (auto symbol = dynamic_cast<const symbol_table::Symbol *>(arg.get()))
+      symbol->getName();
+}
+}  // namespace
+
+// ~~~~~ Parse memo
+ParseMemo::ParseMemo(size_t capacity)
+    : capacity(std::max<size_t>(capacity, 1)) {}
+
+bool ParseMemo::find(
+    std::string_view text,
+    lookup_t::c::ref functions,
+    sym_t::vector::shared &args
+) {
+  auto ite = index.find(text);
+  if (ite == index.end()) {
+    ++miss_count;
+    return false;
+  }
+  auto &entry = *ite->second;
+  if (std::any_of(
+      entry.numbers.begin(), entry.numbers.end(),
+      [&functions](bfd_vma number) { return functions.count(number) != 0; }
+  )) {
+    ++miss_count;
+    return false;
+  }
+  ++hit_count;
+  entries.splice(entries.begin(), entries, ite->second);
+  args = entry.args;
+  return true;
+}
+
+void ParseMemo::insert(
+    std::string_view text,
+    const sym_t::vector::shared &args
+) {
+  render_names(args);
+
+  std::vector<bfd_vma> numbers;
+  for (auto &arg : args)
+    if (!collect_numbers(arg.get(), numbers))
+      return;
+
+  std::lock_guard<std::mutex> guard(lock);
+  // could be there, if it had been bypassed because of some function
+  // or other thread has been faster
+  if (index.count(text))
+    return;
+
+  entries.push_front(Entry{std::string(text), args, std::move(numbers)});
+  index.emplace(entries.front().text, entries.begin());
+  if (entries.size() > capacity) {
+    index.erase(entries.back().text);
+    entries.pop_back();
+  }
+}
+
+size_t ParseMemo::size() const {
+  std::lock_guard<std::mutex> guard(lock);
+  return entries.size();
+}
+
+size_t ParseMemo::hits() const {
+  std::lock_guard<std::mutex> guard(lock);
+  return hit_count;
+}
+
+size_t ParseMemo::misses() const {
+  std::lock_guard<std::mutex> guard(lock);
+  return miss_count;
+}
+// ~~~~~ Parse memo
+}  // namespace befa
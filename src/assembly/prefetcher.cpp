@@ -0,0 +1,132 @@
+//
+// Created by miro on 10/18/26.
+//
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <algorithm>
+
+#include "../../include/befa/utils/assert.hpp"
+#include "../../include/befa/assembly/prefetcher.hpp"
+
+namespace befa {
+
+SectionPrefetcher::SectionPrefetcher(bfd *fd, size_t budget, bool strict)
+    : fd(fd), budget(budget), strict(strict) {}
+
+SectionPrefetcher::~SectionPrefetcher() {
+  {
+    std::lock_guard<std::mutex> guard(lock);
+    stopped = true;
+  }
+  changed.notify_all();
+  if (worker.joinable())
+    worker.join();
+  if (file >= 0)
+    ::close(file);
+}
+
+void SectionPrefetcher::schedule(const asection *section) {
+  if (slots.emplace(section, slot()).second)
+    queue.push_back(section);
+}
+
+void SectionPrefetcher::start() {
+  // there is nothing to overlap with
+  if (budget == 0 || queue.empty())
+    return;
+  if ((file = ::open(bfd_get_filename(fd), O_RDONLY)) < 0)
+    return;
+  worker = std::thread([this] { run(); });
+}
+
+SectionPrefetcher::buffer_t SectionPrefetcher::take(const asection *section) {
+  buffer_t buffer;
+  {
+    std::unique_lock<std::mutex> guard(lock);
+    auto slot_ite = slots.find(section);
+    if (slot_ite != slots.end() && worker.joinable()) {
+      waiting = true;
+      changed.notify_all();
+      changed.wait(guard, [&] { return slot_ite->second.done; });
+      waiting = false;
+      if ((buffer = std::move(slot_ite->second.buffer)))
+        in_flight -= bfd_section_size(fd, section);
+      slots.erase(slot_ite);
+    }
+  }
+  changed.notify_all();
+  return buffer ? std::move(buffer) : load(section);
+}
+
+size_t SectionPrefetcher::peak() const {
+  std::lock_guard<std::mutex> guard(lock);
+  return peak_in_flight;
+}
+
+void SectionPrefetcher::run() {
+  for (const asection *section : queue) {
+    size_t size = bfd_section_size(fd, section);
+    bool fits;
+    {
+      // wait for budget, but never stall the caller (it may take sections
+      // in different order than they were scheduled)
+      std::unique_lock<std::mutex> guard(lock);
+      changed.wait(guard, [&] {
+        return stopped || waiting || (!strict && in_flight == 0)
+            || in_flight + size <= budget;
+      });
+      if (stopped)
+        return;
+      fits = !strict || in_flight + size <= budget;
+    }
+
+    buffer_t buffer;
+    // section that doesn't fit is read by caller
+    if (fits && readable(section)) {
+      buffer.reset(new uint8_t[size]);
+      size_t offset = 0;
+      while (offset < size) {
+        ssize_t got = ::pread(
+            file, buffer.get() + offset, size - offset,
+            section->filepos + offset
+        );
+        if (got <= 0)
+          break;
+        offset += got;
+      }
+      // partial read, let the caller ask BFD
+      if (offset != size)
+        buffer.reset();
+    }
+
+    {
+      std::lock_guard<std::mutex> guard(lock);
+      auto &loaded = slots[section];
+      loaded.done = true;
+      if ((loaded.buffer = std::move(buffer)))
+        peak_in_flight = std::max(peak_in_flight, in_flight += size);
+    }
+    changed.notify_all();
+  }
+}
+
+bool SectionPrefetcher::readable(const asection *section) const {
+  return (bfd_get_section_flags(fd, section) & SEC_HAS_CONTENTS)
+      && !(bfd_get_section_flags(fd, section) & SEC_IN_MEMORY)
+      && section->compress_status == COMPRESS_SECTION_NONE
+      && fd->my_archive == nullptr;
+}
+
+SectionPrefetcher::buffer_t SectionPrefetcher::load(
+    const asection *section
+) const {
+  size_t size = bfd_section_size(fd, section);
+  buffer_t buffer(new uint8_t[size]);
+  assert_ex(buffer, "not enough memory");
+  bfd_get_section_contents(
+      fd, (asection *) section, buffer.get(), 0, size
+  );
+  return buffer;
+}
+}  // namespace befa
@@ -0,0 +1,149 @@
+//
+// Created by miro on 10/18/26.
+//
+
+#include "../../include/befa/llvm/compact.hpp"
+#include "../../include/befa/llvm/call.hpp"
+#include "../../include/befa/llvm/jmp.hpp"
+
+namespace llvm {
+
+// ~~~~~ Construction
+void CompactFunction::binary(
+    a_ir_t::c_info::ref assembly,
+    const sym_t::ptr::shared &target,
+    const sym_t::ptr::shared &lhs,
+    const std::string &op,
+    const sym_t::ptr::shared &rhs
+) {
+  push(BINARY, assembly, intern_operator(op), 0, target, lhs, rhs);
+}
+
+void CompactFunction::unary(
+    a_ir_t::c_info::ref assembly,
+    const sym_t::ptr::shared &target,
+    const std::string &op,
+    const sym_t::ptr::shared &operand
+) {
+  push(UNARY, assembly, intern_operator(op), 0, target, operand, nullptr);
+}
+
+void CompactFunction::compare(
+    a_ir_t::c_info::ref assembly,
+    const sym_t::ptr::shared &result,
+    const sym_t::ptr::shared &lhs,
+    CmpInstruction::types_e predicate,
+    const sym_t::ptr::shared &rhs
+) {
+  push(COMPARE, assembly, 0, (uint8_t) predicate, result, lhs, rhs);
+}
+
+void CompactFunction::call(
+    a_ir_t::c_info::ref assembly,
+    const sym_t::ptr::shared &result,
+    const sym_t::ptr::shared &target
+) {
+  push(CALL, assembly, 0, 0, result, target, nullptr);
+}
+
+void CompactFunction::branch(
+    a_ir_t::c_info::ref assembly,
+    const sym_t::ptr::shared &condition,
+    const sym_t::ptr::shared &target
+) {
+  push(BRANCH, assembly, 0, 0, condition, target, nullptr);
+}
+
+void CompactFunction::append(const ir_t::ptr::shared &instruction) {
+  Record record{OPAQUE, 0, 0, (uint32_t) -1, {no_value, no_value, no_value}};
+  record.operands[0] = (value_id) opaque.size();
+  opaque.push_back(instruction);
+  records.push_back(record);
+}
+
+void CompactFunction::push(
+    kind_e kind,
+    a_ir_t::c_info::ref instruction,
+    uint16_t op,
+    uint8_t predicate,
+    const sym_t::ptr::shared &first,
+    const sym_t::ptr::shared &second,
+    const sym_t::ptr::shared &third
+) {
+  records.push_back(Record{
+      kind, predicate, op, intern_assembly(instruction),
+      {intern_value(first), intern_value(second), intern_value(third)}
+  });
+}
+
+uint32_t CompactFunction::intern_assembly(a_ir_t::c_info::ref instruction) {
+  if (assembly.empty()
+      || assembly.back().getAddress() != instruction.getAddress())
+    assembly.push_back(instruction);
+  return (uint32_t) assembly.size() - 1;
+}
+
+CompactFunction::value_id CompactFunction::intern_value(
+    const sym_t::ptr::shared &value
+) {
+  if (!value)
+    return no_value;
+  auto inserted = value_ids.emplace(value.get(), (value_id) values.size());
+  if (inserted.second)
+    values.push_back(value);
+  return inserted.first->second;
+}
+
+uint16_t CompactFunction::intern_operator(const std::string &op) {
+  for (size_t index = 0; index < operators.size(); ++index)
+    if (operators[index] == op)
+      return (uint16_t) index;
+  assert_ex(operators.size() < 0xffff, "too many operators");
+  operators.push_back(op);
+  return (uint16_t) operators.size() - 1;
+}
+// ~~~~~ Construction
+
+// ~~~~~ View
+CompactFunction::ir_t::ptr::shared CompactFunction::view(size_t index) const {
+  const Record &record = records[index];
+  if (record.kind == OPAQUE)
+    return opaque[record.operands[0]];
+
+  auto operand = [this, &record](size_t i) -> sym_t::ptr::shared {
+    return record.operands[i] == no_value
+           ? nullptr : values[record.operands[i]];
+  };
+  a_ir_t::c_info::ref instruction = getAssembly(record);
+  switch (record.kind) {
+    case BINARY:
+      return std::make_shared<BinaryOperation>(
+          a_ir_t::vector::value{instruction}, operand(0), operand(1),
+          operators[record.op], operand(2)
+      );
+    case UNARY:
+      return std::make_shared<UnaryInstruction>(
+          a_ir_t::vector::value{instruction}, operand(0),
+          operators[record.op], operand(1)
+      );
+    case COMPARE:
+      return std::make_shared<CmpInstruction>(
+          instruction, operand(0), operand(1),
+          (CmpInstruction::types_e) record.predicate, operand(2)
+      );
+    case CALL:
+      return std::make_shared<CallInstruction>(
+          a_ir_t::vector::value{instruction}, operand(0), operand(1)
+      );
+    case BRANCH:
+      return std::make_shared<BranchInstruction>(
+          a_ir_t::vector::value{instruction}, operand(0), operand(1)
+      );
+    default:
+      break;
+  }
+  assert_ex(false, "unknown kind of compact record");
+  return nullptr;
+}
+// ~~~~~ View
+}  // namespace llvm
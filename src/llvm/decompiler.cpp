@@ -2,6 +2,11 @@
 // Created by miro on 11/10/16.
 //
 
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <thread>
+
 #include "../../include/befa/llvm/instruction.hpp"
 
 // requirement classes
@@ -14,6 +19,10 @@
 #include "../../include/befa/llvm/call.hpp"
 #include "../../include/befa/llvm/cmp.hpp"
 
+#include "../../include/befa/llvm/function_cache.hpp"
+#include "../../include/befa/llvm/compact.hpp"
+#include "../../include/befa/llvm/flags.hpp"
+
 #include "../../include/befa.hpp"
 
 void ExecutableFile::runDecompiler() {
@@ -27,67 +36,6 @@ void ExecutableFile::runDecompiler() {
 
 namespace llvm {
 
-// ~~~~~ Mappers
-std::map<std::string, CmpInstruction::types_e>
-    CmpInstruction::str_to_jmp{
-    {"ja", GT},
-    {"jg", GT},
-    {"jnbe", GT},
-    {"jnle", GT},
-
-    {"jae", GE},
-    {"jge", GE},
-    {"jnb", GE},
-    {"jnl", GE},
-
-    {"jb", LT},
-    {"jl", LT},
-    {"jnae", LT},
-    {"jnge", LT},
-
-    {"jbe", LE},
-    {"jle", LE},
-    {"jna", LE},
-    {"jng", LE},
-
-    {"je", EQ},
-    {"jne", NE},
-};
-std::map<CmpInstruction::types_e, std::vector<std::string>>
-    CmpInstruction::jumps{
-    {GT, {
-        "ja",
-        "jg",
-        "jnbe",
-        "jnle",
-    }},
-
-    {GE, {
-        "jae",
-        "jge",
-        "jnb",
-        "jnl",
-    }},
-
-    {LT, {
-        "jb",
-        "jl",
-        "jnae",
-        "jnge",
-    }},
-
-    {LE, {
-        "jbe",
-        "jle",
-        "jna",
-        "jng",
-    }},
-
-    {EQ, {"je"}},
-
-    {NE, {"jne"}},
-};
-
 InstructionVisitorL create_traversal(
     InstructionMapper::addr_t::vector::value &addresses
 ) {
@@ -115,33 +63,335 @@ traits::ir::rx::shared_subs InstructionMapper::subscriber() const {
   return created_instructions.get_subscriber();
 }
 
+namespace {
+/**
+ * Calls body(index) for every index in [0, count) on workers threads
+ * (calling one included), exception of the lowest index is rethrown
+ */
+template<typename BodyT>
+void parallel_for(size_t count, size_t workers, BodyT &&body) {
+  if (!workers)
+    workers = std::max(1u, std::thread::hardware_concurrency());
+  workers = std::min(workers, count);
+
+  std::atomic<size_t> next(0);
+  std::vector<std::exception_ptr> errors(count);
+  auto run = [&] {
+    for (size_t index; (index = next++) < count;)
+      try {
+        body(index);
+      } catch (...) {
+        errors[index] = std::current_exception();
+      }
+  };
+  std::vector<std::thread> threads;
+  for (size_t worker = 1; worker < workers; ++worker)
+    threads.emplace_back(run);
+  run();
+  for (auto &thread : threads)
+    thread.join();
+  for (auto &error : errors)
+    if (error)
+      std::rethrow_exception(error);
+}
+
+/**
+ * @return identity of function of instruction (nullptr out of disassembly)
+ */
+const void *function_of(const traits::a_ir::info::type &instruction) {
+  return instruction.hasParent()
+         ? instruction.getParent()->getParent().lock().get()
+         : nullptr;
+}
+
+/**
+ * How instructions of function are lifted
+ */
+struct LiftPlan {
+  /** flags live after instruction */
+  std::vector<uint8_t> live;
+
+  /** instruction is lifted together with the next one (@see BranchFusion) */
+  std::vector<bool> fused;
+};
+
+/**
+ * @param liveness computes live flags (otherwise all of them are live)
+ * @param fusion fuses cmp/test with jcc of the same block, if flags
+ *        are not read after jcc
+ */
+LiftPlan plan_function(
+    const traits::a_ir::vector::value &function,
+    bool liveness,
+    bool fusion
+) {
+  LiftPlan plan{
+      std::vector<uint8_t>(function.size(), ALL_FLAGS),
+      std::vector<bool>(function.size(), false)
+  };
+  if (!liveness && !fusion)
+    return plan;
+
+  FlowGraph graph(function);
+  auto live = flag_liveness(function, graph);
+  if (fusion)
+    for (uint32_t i = 0; i + 1 < function.size(); ++i) {
+      auto compare = function[i].getMnemonicId();
+      if (BranchFusion::fusable(compare, function[i + 1].getMnemonicId())
+          && graph.blockOf(i) == graph.blockOf(i + 1)
+          && !(live[i + 1] & flags_defined(compare)))
+        plan.fused[i++] = true;
+    }
+  if (liveness)
+    plan.live = std::move(live);
+  return plan;
+}
+}  // namespace
+
 InstructionMapper::sym_table_t::rx::shared_obs InstructionMapper::reduce_instr(
     traits::a_ir::rx::obs o$
 ) {
+  auto session = cache_session;
+  // operands of this batch are shared and freed together with instructions
+  auto pool = std::make_shared<symbol_table::ExpressionPool>(
+      std::make_shared<befa::Arena>(), parse_memo
+  );
+  // instructions of function waiting for flag liveness
+  auto pending = std::make_shared<a_ir_t::vector::value>();
+  auto pending_function = std::make_shared<const void *>(nullptr);
+  auto flush = [this, session, pending](
+      const sym_table_t::ptr::shared &table,
+      const ir_t::rx::shared_subs &output
+  ) {
+    lift_planned(*pending, table, output, session.get());
+    pending->clear();
+  };
   return o$
-      .reduce(std::make_tuple(symbol_table, subscriber()), [&](
+      .reduce(std::make_tuple(symbol_table, subscriber()), [&, session, pool,
+          pending, pending_function, flush](
           std::tuple<
               sym_table_t::ptr::shared,
               ir_t::rx::shared_subs
           > acc,
           const traits::a_ir::info::type &i
       ) {
-        for (auto &factory : factories)
-          factory->operator()(
-              i, std::get<0>(acc), std::get<1>(acc)
-          );
+        if (std::get<0>(acc)->getPool() != pool)
+          std::get<0>(acc)->setPool(pool);
+        // function is taken now, basic block may be released before lifting
+        if (!use_flag_liveness && !use_branch_fusion) {
+          if (session)
+            session->begin(CacheSession::function_of(i));
+          lift_instruction(i, std::get<0>(acc), std::get<1>(acc), session.get());
+          return acc;
+        }
+        const void *function = function_of(i);
+        if (!pending->empty() && *pending_function != function)
+          flush(std::get<0>(acc), std::get<1>(acc));
+        if (pending->empty()) {
+          *pending_function = function;
+          if (session)
+            session->begin(CacheSession::function_of(i));
+        }
+        pending->push_back(i);
         return acc;
       })
-      .map([](
+      .map([session, pending, flush](
           std::tuple<
               sym_table_t::ptr::shared,
               ir_t::rx::shared_subs
           > acc
-      ) { return std::get<0>(acc); });
+      ) {
+        if (!pending->empty())
+          flush(std::get<0>(acc), std::get<1>(acc));
+        if (session)
+          session->finish();
+        std::get<0>(acc)->setPool(nullptr);
+        return std::get<0>(acc);
+      });
+}
+
+void InstructionMapper::lift_planned(
+    const a_ir_t::vector::value &function,
+    const sym_table_t::ptr::shared &table,
+    const ir_t::rx::shared_subs &output,
+    CacheSession *session
+) const {
+  // fused pair has no single instruction to be replayed for
+  auto plan = plan_function(
+      function, use_flag_liveness, use_branch_fusion && !session
+  );
+  for (size_t index = 0; index < function.size(); ++index) {
+    if (plan.fused[index]) {
+      BranchFusion()(function[index], function[index + 1], table, output);
+      ++index;
+      continue;
+    }
+    table->setLiveFlags(plan.live[index]);
+    lift_instruction(function[index], table, output, session);
+  }
+  table->setLiveFlags(ALL_FLAGS);
+}
+
+void InstructionMapper::lift_instruction(
+    a_ir_t::c_info::ref i,
+    const sym_table_t::ptr::shared &table,
+    const ir_t::rx::shared_subs &output,
+    CacheSession *session
+) const {
+  if (session && session->replay(i, output))
+    return;
+  for (auto &factory : dispatch[(size_t) i.getMnemonicId()])
+    factory->operator()(i, table, output);
+}
+
+InstructionMapper::sym_table_t::rx::shared_obs
+InstructionMapper::reduce_functions(
+    traits::a_ir::rx::obs o$,
+    size_t workers
+) {
+  struct function_t {
+    const void *identity;
+    /** started when function is received (nullptr without cache) */
+    std::shared_ptr<CacheSession> session;
+    a_ir_t::vector::value instructions;
+  };
+  using functions_t = std::shared_ptr<std::vector<function_t>>;
+  auto cache = function_cache;
+  return o$
+      .reduce(std::make_shared<std::vector<function_t>>(), [cache](
+          functions_t acc,
+          const traits::a_ir::info::type &i
+      ) {
+        // disassembler emits function after function
+        const void *function = function_of(i);
+        if (acc->empty() || acc->back().identity != function) {
+          std::shared_ptr<CacheSession> session;
+          if (cache) {
+            session = std::make_shared<CacheSession>(cache);
+            session->begin(CacheSession::function_of(i));
+          }
+          acc->push_back(function_t{function, session, {}});
+        }
+        acc->back().instructions.push_back(i);
+        return acc;
+      })
+      .map([&, workers](functions_t functions) {
+        std::vector<sym_table_t::ptr::shared> tables(functions->size());
+        std::vector<ir_t::vector::shared> lifted(functions->size());
+        std::shared_ptr<const SymTable> global = symbol_table;
+        parallel_for(functions->size(), workers, [&](size_t index) {
+          tables[index] = std::make_shared<SymTable>(global);
+          auto &function = (*functions)[index];
+          lifted[index] = lift_function(
+              function.instructions, tables[index], function.session
+          );
+        });
+
+        auto output = subscriber();
+        for (size_t index = 0; index < functions->size(); ++index) {
+          symbol_table->merge(*tables[index]);
+          for (auto &instruction : lifted[index])
+            output.on_next(instruction);
+        }
+        return symbol_table;
+      });
+}
+
+InstructionMapper::ir_t::vector::shared InstructionMapper::lift_function(
+    const a_ir_t::vector::value &function,
+    const sym_table_t::ptr::shared &local,
+    const std::shared_ptr<CacheSession> &session
+) const {
+  ir_t::vector::shared lifted;
+  ir_t::rx::shared_subj created;
+  created.get_observable().subscribe([&lifted](
+      const ir_t::ptr::shared &instruction
+  ) { lifted.push_back(instruction); });
+
+  // session of mapper follows one function at a time
+  if (session)
+    created.get_observable().subscribe([session](
+        const ir_t::ptr::shared &instruction
+    ) { session->record(instruction); });
+
+  local->setPool(std::make_shared<symbol_table::ExpressionPool>(
+      std::make_shared<befa::Arena>(), parse_memo
+  ));
+  lift_planned(function, local, created.get_subscriber(), session.get());
+  if (session)
+    session->finish();
+  local->setPool(nullptr);
+  return lifted;
+}
+
+std::shared_ptr<CompactFunction> InstructionMapper::lift_compact(
+    const a_ir_t::vector::value &function
+) {
+  auto compact = std::make_shared<CompactFunction>();
+  auto pool = symbol_table->getPool();
+  symbol_table->setPool(std::make_shared<symbol_table::ExpressionPool>(
+      std::make_shared<befa::Arena>(), parse_memo
+  ));
+  auto plan = plan_function(function, use_flag_liveness, use_branch_fusion);
+  for (size_t index = 0; index < function.size(); ++index) {
+    auto &i = function[index];
+    if (plan.fused[index]) {
+      BranchFusion().lift(i, function[++index], symbol_table, *compact);
+      continue;
+    }
+    symbol_table->setLiveFlags(plan.live[index]);
+    for (auto &factory : dispatch[(size_t) i.getMnemonicId()])
+      factory->lift(i, symbol_table, *compact);
+  }
+  symbol_table->setLiveFlags(ALL_FLAGS);
+  symbol_table->setPool(pool);
+  return compact;
 }
 
 void InstructionMapper::register_factory(fact_t::ptr::shared ptr) {
   factories.push_back(ptr);
+  update_dispatch();
+}
+
+void InstructionMapper::update_dispatch() {
+  for (size_t mnemonic = 0; mnemonic < dispatch.size(); ++mnemonic) {
+    auto &handlers = dispatch[mnemonic];
+    handlers.clear();
+    for (auto &factory : factories)
+      if (factory->handles((befa::Mnemonic) mnemonic))
+        handlers.push_back(factory);
+  }
+}
+
+void InstructionMapper::set_function_cache(
+    std::shared_ptr<FunctionCache> cache
+) {
+  function_cache = cache;
+  // previous session must not record anymore
+  cache_recording.unsubscribe();
+  if (!cache) {
+    cache_session = nullptr;
+    return;
+  }
+  auto session = cache_session = std::make_shared<CacheSession>(cache);
+  // session picks up what factories has created
+  cache_recording = observable().subscribe([session](
+      const ir_t::ptr::shared &instruction
+  ) { session->record(instruction); });
+}
+
+void InstructionMapper::set_flag_liveness(bool enabled) {
+  use_flag_liveness = enabled;
+}
+
+void InstructionMapper::set_branch_fusion(bool enabled) {
+  use_branch_fusion = enabled;
+}
+
+void InstructionMapper::set_parse_memo(
+    std::shared_ptr<befa::ParseMemo> memo
+) {
+  parse_memo = std::move(memo);
 }
 
 void InstructionMapper::remove_factory(const fact_t::ptr::raw ptr) {
@@ -151,43 +401,91 @@ void InstructionMapper::remove_factory(const fact_t::ptr::raw ptr) {
         return fac.get() == ptr;
       }
   ), factories.end());
+  update_dispatch();
 }
 
 InstructionMapper::InstructionMapper(const InstructionMapper &self)
     : symbol_table(self.symbol_table),
       factories(self.factories),
+      dispatch(self.dispatch),
       traversed_addresses(self.traversed_addresses),
       append_traversed_addr(self.append_traversed_addr),
-      created_instructions(self.created_instructions) {}
+      created_instructions(self.created_instructions),
+      cache_session(self.cache_session),
+      function_cache(self.function_cache),
+      parse_memo(self.parse_memo),
+      use_flag_liveness(self.use_flag_liveness),
+      use_branch_fusion(self.use_branch_fusion) {}
 // ~~~~~ Mappers
 
 // ~~~~~ Symbol Table
+namespace {
+/**
+ * @return address of symbol or -1 for non-symbols
+ */
+bfd_vma symbol_address(const SymTable::sym_t::ptr::shared &symbol) {
+  auto sym = dynamic_cast<const symbol_table::Symbol *>(symbol.get());
+  return sym ? sym->getAddress() : (bfd_vma) -1;
+}
+}  // namespace
+
+SymTable::SymTable(
+    sym_map_t::ptr::shared symbol_map
+) : symbol_map(symbol_map) {
+  by_name.reserve(symbol_map->size());
+  for (auto &symbol : *symbol_map)
+    index_symbol(symbol.first, symbol.second);
+}
+
+SymTable::SymTable(
+    std::shared_ptr<const SymTable> global
+) : symbol_map(std::make_shared<sym_map_t::type>()),
+    global(std::move(global)) {
+  assert_ex(!this->global->global, "global symbol table is layered");
+}
+
+void SymTable::index_symbol(
+    const std::string &name,
+    const sym_t::ptr::shared &symbol
+) {
+  by_name.emplace(name, symbol);
+  // symbols without address (registers, temporaries) use -1
+  bfd_vma address = symbol_address(symbol);
+  if (!global || !global->addresses.count(address))
+    addresses.emplace(address, symbol);
+  if (address != (bfd_vma) -1)
+    by_address.emplace(address, symbol);
+}
+
 traits::symbol::ptr::shared SymTable::find_symbol(
     const std::string &name
 ) const {
-  bool result = false;
-  auto visitor = symbol_table::SymbolVisitorL([&result, &name]
-      (const symbol_table::Symbol *visitable) {
-    result = (visitable->getName().find(name) != std::string::npos);
-  });
-  for (auto &sym : *symbol_map) {
-    invoke_accept(sym.second, visitor);
-    if (result) return sym.second;
-  }
-  return nullptr;
+  auto ite = by_name.find(name);
+  if (ite != by_name.end())
+    return ite->second;
+  return global ? global->find_symbol(name) : nullptr;
 }
 
 traits::symbol::ptr::shared SymTable::find_symbol(bfd_vma address) const {
+  auto ite = by_address.find(address);
+  if (ite != by_address.end())
+    return ite->second;
+  return global ? global->find_symbol(address) : nullptr;
+}
+
+traits::symbol::ptr::shared SymTable::find_symbol_containing(
+    const std::string &part
+) const {
   bool result = false;
-  auto visitor = symbol_table::SymbolVisitorL([&result, &address]
+  auto visitor = symbol_table::SymbolVisitorL([&result, &part]
       (const symbol_table::Symbol *visitable) {
-    result = (visitable->getAddress() == address);
+    result = (visitable->getName().find(part) != std::string::npos);
   });
   for (auto &sym : *symbol_map) {
     invoke_accept(sym.second, visitor);
     if (result) return sym.second;
   }
-  return nullptr;
+  return global ? global->find_symbol_containing(part) : nullptr;
 }
 
 bfd_vma SymTable::get_address(SymTable::sym_t::ptr::shared sym) const {
@@ -201,14 +499,25 @@ bfd_vma SymTable::get_address(SymTable::sym_t::ptr::shared sym) const {
 }
 
 instruction_parser::sym_map_t::type SymTable::to_map() const {
-  return ::map(*symbol_map, [](const auto &item) {
-    bfd_vma address;
-    invoke_accept(item.second, symbol_table::SymbolVisitorL(
-        [&address] (auto sym_ptr) {
-          address = sym_ptr->getAddress();
-        }));
-    return std::make_pair(address, item.second);
-  }, instruction_parser::sym_map_t::type());
+  if (!global)
+    return addresses;
+  auto map = global->addresses;
+  map.insert(addresses.begin(), addresses.end());
+  return map;
+}
+
+instruction_parser::lookup_t::type SymTable::address_map() const {
+  return global
+         ? instruction_parser::AddressLookup(addresses, &global->addresses)
+         : instruction_parser::AddressLookup(addresses);
+}
+
+void SymTable::merge(const SymTable &local) {
+  for (auto &symbol : *local.symbol_map)
+    if (!find_symbol(symbol.first)) {
+      symbol_map->emplace(symbol);
+      index_symbol(symbol.first, symbol.second);
+    }
 }
 
 SymTable::sym_t::ptr::shared   SymTable::add_symbol(
@@ -217,13 +526,14 @@ SymTable::sym_t::ptr::shared   SymTable::add_symbol(
   std::string name;
   invoke_accept(symbol, symbol_table::SymbolVisitorL(
       [&name] (const symbol_table::Symbol *sym) {
-        name = sym->getAddress();
+        name = sym->getName();
       }
   ));
   assert_ex(
       symbol_map->emplace(std::make_pair(name, symbol)).second,
       "Failed to insert symbol into symbol table"
   );
+  index_symbol(name, symbol);
   return symbol;
 }
 // ~~~~~ Symbol Table
@@ -398,6 +708,87 @@ std::string Assignment::toString() const {
 
 // ~~~~~ Assignment
 
+// ~~~~~ Emitter
+namespace {
+/**
+ * Emits instructions as objects into subscriber
+ * (CompactFunction has the same interface for records)
+ */
+struct ObjectEmitter {
+  using a_ir_t = traits::a_ir;
+
+  void binary(
+      a_ir_t::c_info::ref assembly,
+      const sym_t::ptr::shared &target,
+      const sym_t::ptr::shared &lhs,
+      const std::string &op,
+      const sym_t::ptr::shared &rhs
+  ) {
+    subscriber.on_next(std::make_shared<BinaryOperation>(
+        a_ir_t::vector::value{assembly}, target, lhs, op, rhs
+    ));
+  }
+
+  void unary(
+      a_ir_t::c_info::ref assembly,
+      const sym_t::ptr::shared &target,
+      const std::string &op,
+      const sym_t::ptr::shared &operand
+  ) {
+    subscriber.on_next(std::make_shared<UnaryInstruction>(
+        a_ir_t::vector::value{assembly}, target, op, operand
+    ));
+  }
+
+  void compare(
+      a_ir_t::c_info::ref assembly,
+      const sym_t::ptr::shared &result,
+      const sym_t::ptr::shared &lhs,
+      CmpInstruction::types_e predicate,
+      const sym_t::ptr::shared &rhs
+  ) {
+    subscriber.on_next(std::make_shared<CmpInstruction>(
+        assembly, result, lhs, predicate, rhs
+    ));
+  }
+
+  void call(
+      a_ir_t::c_info::ref assembly,
+      const sym_t::ptr::shared &result,
+      const sym_t::ptr::shared &target
+  ) {
+    subscriber.on_next(std::make_shared<CallInstruction>(
+        a_ir_t::vector::value{assembly}, result, target
+    ));
+  }
+
+  void branch(
+      a_ir_t::c_info::ref assembly,
+      const sym_t::ptr::shared &condition,
+      const sym_t::ptr::shared &target
+  ) {
+    subscriber.on_next(std::make_shared<BranchInstruction>(
+        a_ir_t::vector::value{assembly}, condition, target
+    ));
+  }
+
+  ir_t::rx::shared_subs subscriber;
+};
+}  // namespace
+
+void LLVMFactory::lift(
+    a_ir_t::c_info::ref asm_ir,
+    sym_table_t::ptr::shared sym_table,
+    CompactFunction &function
+) const {
+  ir_t::rx::shared_subj created;
+  created.get_observable().subscribe([&function](
+      const ir_t::ptr::shared &instruction
+  ) { function.append(instruction); });
+  operator()(asm_ir, sym_table, created.get_subscriber());
+}
+// ~~~~~ Emitter
+
 // ~~~~~ CALL implementation
 CallInstruction::CallInstruction(
     const a_vec_t&          assembly,
@@ -417,36 +808,53 @@ std::string CallInstruction::toString() const {
 
 const std::string CallInstruction::an_operator = "call";
 
-void CallFactory::operator()(
-    a_ir_t::c_info::ref i,
-    sym_table_t::ptr::shared symbol_table,
-    ir_t::rx::shared_subs subscriber
-) const {
-  if (i.getName() == "call")
+bool CallFactory::handles(befa::Mnemonic mnemonic) const {
+  return befa::is_call(mnemonic);
+}
+
+namespace {
+template<typename EmitterT>
+void lift_call(
+    LLVMFactory::a_ir_t::c_info::ref i,
+    const LLVMFactory::sym_table_t::ptr::shared &symbol_table,
+    EmitterT &emit
+) {
+  if (befa::is_call(i.getMnemonicId()))
     // first parameter is target of call
-    i.getArgs(symbol_table->to_map())
+    i.getArgs(symbol_table->address_map(), symbol_table->getPool())
      .first()
      .subscribe([&](
          std::shared_ptr<symbol_table::VisitableBase> target
      ) {
        // if return value is integer under 32bits
        // it will be really there (workaround for now)
-       auto call_i = std::make_shared<CallInstruction>(
-           a_ir_t::vector::value({i}),
+       emit.call(
+           i,
            symbol_table->get_or_create<
                symbol_table::SizedTemporary<symbol_table::types::DWORD>
-           >("Temporary", "ResultOfTheCall"),
+           >("ResultOfTheCall", "ResultOfTheCall"),
            target
        );
-//       invoke_accept(eax, symbol_table::RegisterVisitorL(
-//           [] (const symbol_table::RegisterBase *reg) {
-//         printf("%s\n", reg->getName().c_str());
-//       }));
-       subscriber.on_next(
-           std::static_pointer_cast<llvm::VisitableBase>(call_i)
-       );
      });
 }
+}  // namespace
+
+void CallFactory::operator()(
+    a_ir_t::c_info::ref i,
+    sym_table_t::ptr::shared symbol_table,
+    ir_t::rx::shared_subs subscriber
+) const {
+  ObjectEmitter emit{subscriber};
+  lift_call(i, symbol_table, emit);
+}
+
+void CallFactory::lift(
+    a_ir_t::c_info::ref i,
+    sym_table_t::ptr::shared symbol_table,
+    CompactFunction &function
+) const {
+  lift_call(i, symbol_table, function);
+}
 // ~~~~~ CALL implementation
 
 // ~~~~~ CMP implementation
@@ -471,7 +879,11 @@ CmpInstruction::CmpInstruction(
     const sym_t::ptr::shared&  rhs
 ) : BinaryOperation(
     {assembly}, result, lhs, type_to_str[op], rhs
-) {}
+), predicate(op) {}
+
+const std::string &CmpInstruction::predicateName(types_e predicate) {
+  return type_to_str[predicate];
+}
 
 std::string CmpInstruction::toString() const {
   auto args = getUsedSymbols();
@@ -516,16 +928,25 @@ struct DummyInstruction : public Instruction {
   std::string __str;
 };
 
-void CompareFactory::operator()(
-    a_ir_t::c_info::ref instruction,
-    sym_table_t::ptr::shared symbol_table,
-    ir_t::rx::shared_subs subscriber
-) const {
-  auto name = instruction.getName();
+bool CompareFactory::handles(befa::Mnemonic mnemonic) const {
+  return mnemonic == befa::Mnemonic::_cmp
+      || mnemonic == befa::Mnemonic::_test;
+}
+
+namespace {
+template<typename EmitterT>
+void lift_compare(
+    LLVMFactory::a_ir_t::c_info::ref instruction,
+    const LLVMFactory::sym_table_t::ptr::shared &symbol_table,
+    EmitterT &emit
+) {
+  auto mnemonic = instruction.getMnemonicId();
+  // flags nobody reads are not computed (@see flag_liveness)
+  uint8_t live = symbol_table->getLiveFlags();
 
-  if (name == "cmp") {
+  if (mnemonic == befa::Mnemonic::_cmp && (live & (ZF | CF))) {
     instruction
-        .getArgs(symbol_table->to_map())
+        .getArgs(symbol_table->address_map(), symbol_table->getPool())
         .reduce(std::vector<sym_t::ptr::shared>(), [](
             std::vector<sym_t::ptr::shared> acc,
             sym_t::ptr::shared sym_ptr
@@ -536,26 +957,28 @@ void CompareFactory::operator()(
         .subscribe([&](
             std::vector<sym_t::ptr::shared> args
         ) {
-          auto zf = symbol_table->find_symbol("_zf");
-          auto cf = symbol_table->find_symbol("_cf");
+          auto zf = symbol_table->find_symbol("zf");
+          auto cf = symbol_table->find_symbol("cf");
           assert_ex(
               zf && cf,
               "cannot continue without essential registers"
           );
 
-          subscriber.on_next(std::make_shared<llvm::CmpInstruction>(
-              instruction, zf, args[0], CmpInstruction::EQ, args[1]
-          ));
+          if (live & ZF)
+            emit.compare(
+                instruction, zf, args[0], CmpInstruction::EQ, args[1]
+            );
 
-          subscriber.on_next(std::make_shared<llvm::CmpInstruction>(
-              instruction, cf, args[0], CmpInstruction::LT, args[1]
-          ));
+          if (live & CF)
+            emit.compare(
+                instruction, cf, args[0], CmpInstruction::LT, args[1]
+            );
         });
   }
 
-  if (name == "test") {
+  if (mnemonic == befa::Mnemonic::_test && (live & (ZF | SF | PF))) {
     instruction
-        .getArgs(symbol_table->to_map())
+        .getArgs(symbol_table->address_map(), symbol_table->getPool())
         .reduce(std::vector<sym_t::ptr::shared>(), [](
             std::vector<sym_t::ptr::shared> acc,
             sym_t::ptr::shared sym_ptr
@@ -567,41 +990,49 @@ void CompareFactory::operator()(
             std::vector<sym_t::ptr::shared> args
         ) {
           auto temporary = std::make_shared<symbol_table::Symbol>("Temporary");
-          auto zf = symbol_table->find_symbol("_zf");
-          auto sf = symbol_table->find_symbol("_sf");
-          auto pf = symbol_table->find_symbol("_pf");
+          auto zf = symbol_table->find_symbol("zf");
+          auto sf = symbol_table->find_symbol("sf");
+          auto pf = symbol_table->find_symbol("pf");
           assert_ex(
               zf && sf && pf,
               "cannot continue without essential registers"
           );
 
-          subscriber.on_next(std::make_shared<llvm::BinaryOperation>(
-              a_ir_t::vector::value{instruction}, temporary, args[0], "AND", args[1]
-          ));
-          subscriber.on_next(std::make_shared<llvm::UnaryInstruction>(
-              a_ir_t::vector::value{instruction}, sf, "MSB", temporary
-          ));
+          emit.binary(instruction, temporary, args[0], "AND", args[1]);
+          if (live & SF)
+            emit.unary(instruction, sf, "MSB", temporary);
 
-          subscriber.on_next(std::make_shared<llvm::CmpInstruction>(
-               instruction, zf, temporary, CmpInstruction::EQ,
-               std::make_shared<symbol_table::Immidiate>("0")
-          ));
+          if (live & ZF)
+            emit.compare(
+                 instruction, zf, temporary, CmpInstruction::EQ,
+                 std::make_shared<symbol_table::Immidiate>("0")
+            );
 
           // get parity flag via BitwiseXNOR - 1 is odd, 0 is even
-          subscriber.on_next(std::make_shared<llvm::UnaryInstruction>(
-              a_ir_t::vector::value{instruction}, pf, "BitwiseXNOR", temporary
-          ));
+          if (live & PF)
+            emit.unary(instruction, pf, "BitwiseXNOR", temporary);
         });
   }
 }
-// ~~~~~ CMP implementation
+}  // namespace
 
-static std::vector<std::string> jumps = ::map(
-    CmpInstruction::str_to_jmp,
-    [] (const ::std::pair<std::string, CmpInstruction::types_e> &str_jmp) {
-      return str_jmp.first;
-    }
-);
+void CompareFactory::operator()(
+    a_ir_t::c_info::ref instruction,
+    sym_table_t::ptr::shared symbol_table,
+    ir_t::rx::shared_subs subscriber
+) const {
+  ObjectEmitter emit{subscriber};
+  lift_compare(instruction, symbol_table, emit);
+}
+
+void CompareFactory::lift(
+    a_ir_t::c_info::ref instruction,
+    sym_table_t::ptr::shared symbol_table,
+    CompactFunction &function
+) const {
+  lift_compare(instruction, symbol_table, function);
+}
+// ~~~~~ CMP implementation
 
 // ~~~~~ JMP implementation
 
@@ -611,88 +1042,206 @@ std::string BranchInstruction::toString() const {
       + ", address " + std::get<0>(details::fetch_name(getTarget()));
 }
 
-void JumpFactory::operator()(
-    a_ir_t::c_info::ref instruction,
-    sym_table_t::ptr::shared symbol_table,
-    ir_t::rx::shared_subs subscriber
-) const {
-  auto name = instruction.getName();
-  auto cf = symbol_table->find_symbol("_cf");
-  auto zf = symbol_table->find_symbol("_zf");
+bool JumpFactory::handles(befa::Mnemonic mnemonic) const {
+  return befa::is_jcc(mnemonic);
+}
+
+namespace {
+template<typename EmitterT>
+void lift_jump(
+    LLVMFactory::a_ir_t::c_info::ref instruction,
+    const LLVMFactory::sym_table_t::ptr::shared &symbol_table,
+    EmitterT &emit
+) {
+  auto mnemonic = instruction.getMnemonicId();
+  if (!befa::is_jcc(mnemonic))
+    return;
+
+  auto cf = symbol_table->find_symbol("cf");
+  auto zf = symbol_table->find_symbol("zf");
   auto zero = std::make_shared<symbol_table::Immidiate>("0");
   auto one = std::make_shared<symbol_table::Immidiate>("1");
   auto result = std::make_shared<symbol_table::Symbol>("TempResult");
   bool was_jump = false;
 
-  if (contains(CmpInstruction::jumps[CmpInstruction::GT], name)) {
-    was_jump = true;
-    // CF = 0 and ZF = 0
-    auto temp = std::make_shared<symbol_table::Symbol>("Temp2Result");
-
-    subscriber.on_next(
-        std::make_shared<CmpInstruction>(
-            instruction, result, cf, CmpInstruction::EQ, zero
-        )
-    );
-    subscriber.on_next(
-        std::make_shared<CmpInstruction>(
-            instruction, temp, zf, CmpInstruction::EQ, zero
-        )
-    );
-    subscriber.on_next(
-        std::make_shared<BinaryOperation>(
-            a_ir_t::vector::value{instruction}, result, temp, "AND", result
-        )
-    );
-  } else if (contains(CmpInstruction::jumps[CmpInstruction::LE], name)) {
-    was_jump = true;
-    // CF = 1 or ZF = 1
-    auto temp = std::make_shared
-        <symbol_table::Symbol>("Temp2Result");
-
-    subscriber.on_next(
-        std::make_shared<CmpInstruction>(
-            instruction, result, cf, CmpInstruction::EQ, one
-        )
-    );
-    subscriber.on_next(
-        std::make_shared<CmpInstruction>(
-            instruction, temp, zf, CmpInstruction::EQ, one
-        )
-    );
-    subscriber.on_next(
-        std::make_shared<BinaryOperation>(
-            a_ir_t::vector::value{instruction}, result, temp, "OR", result
-        )
-    );
-  } else if (contains(CmpInstruction::jumps[CmpInstruction::GE], name)) {
-    // CF = 0
-
-  } else if (contains(CmpInstruction::jumps[CmpInstruction::LT], name)) {
-    // CF = 1
-
-  } else if (contains(CmpInstruction::jumps[CmpInstruction::NE], name)) {
-    // ZF = 0
-
-  } else if (contains(CmpInstruction::jumps[CmpInstruction::EQ], name)) {
-    // ZF = 1
-
+  switch (befa::condition(mnemonic)) {
+    // ja, jg
+    case befa::Condition::a:
+    case befa::Condition::g: {
+      was_jump = true;
+      // CF = 0 and ZF = 0
+      auto temp = std::make_shared<symbol_table::Symbol>("Temp2Result");
+
+      emit.compare(instruction, result, cf, CmpInstruction::EQ, zero);
+      emit.compare(instruction, temp, zf, CmpInstruction::EQ, zero);
+      emit.binary(instruction, result, temp, "AND", result);
+      break;
+    }
+    // jbe, jle
+    case befa::Condition::be:
+    case befa::Condition::le: {
+      was_jump = true;
+      // CF = 1 or ZF = 1
+      auto temp = std::make_shared
+          <symbol_table::Symbol>("Temp2Result");
+
+      emit.compare(instruction, result, cf, CmpInstruction::EQ, one);
+      emit.compare(instruction, temp, zf, CmpInstruction::EQ, one);
+      emit.binary(instruction, result, temp, "OR", result);
+      break;
+    }
+    // jae, jge
+    case befa::Condition::ae:
+    case befa::Condition::ge:
+      // CF = 0
+      break;
+    // jb, jl
+    case befa::Condition::b:
+    case befa::Condition::l:
+      // CF = 1
+      break;
+    case befa::Condition::ne:
+      // ZF = 0
+      break;
+    case befa::Condition::e:
+      // ZF = 1
+      break;
+    default:
+      break;
   }
 
   if (was_jump)
     instruction
-        .getArgs()
+        .getArgs({}, symbol_table->getPool())
         .first()
         .subscribe([&] (auto arg) {
-          subscriber.on_next(
-              std::make_shared<BranchInstruction>(
-                  a_ir_t::vector::value{instruction}, result, arg
-              )
-          );
+          emit.branch(instruction, result, arg);
         });
 }
+}  // namespace
+
+void JumpFactory::operator()(
+    a_ir_t::c_info::ref instruction,
+    sym_table_t::ptr::shared symbol_table,
+    ir_t::rx::shared_subs subscriber
+) const {
+  ObjectEmitter emit{subscriber};
+  lift_jump(instruction, symbol_table, emit);
+}
+
+void JumpFactory::lift(
+    a_ir_t::c_info::ref instruction,
+    sym_table_t::ptr::shared symbol_table,
+    CompactFunction &function
+) const {
+  lift_jump(instruction, symbol_table, function);
+}
 // ~~~~~ JMP implementation
 
+// ~~~~~ Branch fusion
+namespace {
+/**
+ * @return predicate of compare (cmp, test) followed by jump on condition,
+ *         false if pair can't be fused
+ */
+std::pair<CmpInstruction::types_e, bool> fused_predicate(
+    befa::Mnemonic compare,
+    befa::Condition condition
+) {
+  using befa::Condition;
+  if (compare == befa::Mnemonic::_cmp)
+    switch (condition) {
+      case Condition::e:  return {CmpInstruction::EQ, true};
+      case Condition::ne: return {CmpInstruction::NE, true};
+      case Condition::a:  return {CmpInstruction::UGT, true};
+      case Condition::ae: return {CmpInstruction::UGE, true};
+      case Condition::b:  return {CmpInstruction::ULT, true};
+      case Condition::be: return {CmpInstruction::ULE, true};
+      case Condition::g:  return {CmpInstruction::GT, true};
+      case Condition::ge: return {CmpInstruction::GE, true};
+      case Condition::l:  return {CmpInstruction::LT, true};
+      case Condition::le: return {CmpInstruction::LE, true};
+      default: break;
+    }
+  // result of test against 0 (test clears CF and OF)
+  if (compare == befa::Mnemonic::_test)
+    switch (condition) {
+      case Condition::e:
+      case Condition::be: return {CmpInstruction::EQ, true};
+      case Condition::ne:
+      case Condition::a:  return {CmpInstruction::NE, true};
+      case Condition::s:
+      case Condition::l:  return {CmpInstruction::LT, true};
+      case Condition::ns:
+      case Condition::ge: return {CmpInstruction::GE, true};
+      case Condition::g:  return {CmpInstruction::GT, true};
+      case Condition::le: return {CmpInstruction::LE, true};
+      default: break;
+    }
+  return {CmpInstruction::EQ, false};
+}
+
+template<typename EmitterT>
+void lift_fused(
+    LLVMFactory::a_ir_t::c_info::ref compare,
+    LLVMFactory::a_ir_t::c_info::ref jump,
+    const LLVMFactory::sym_table_t::ptr::shared &symbol_table,
+    EmitterT &emit
+) {
+  auto predicate = fused_predicate(
+      compare.getMnemonicId(), befa::condition(jump.getMnemonicId())
+  ).first;
+  std::vector<sym_t::ptr::shared> args;
+  compare
+      .getArgs(symbol_table->address_map(), symbol_table->getPool())
+      .subscribe([&args](sym_t::ptr::shared arg) { args.push_back(arg); });
+  assert_ex(args.size() >= 2, "compare has to have two operands");
+
+  auto lhs = args[0], rhs = args[1];
+  if (compare.getMnemonicId() == befa::Mnemonic::_test) {
+    // test eax, eax tests eax itself
+    if (lhs != rhs) {
+      auto temporary = std::make_shared<symbol_table::Symbol>("Temporary");
+      emit.binary(compare, temporary, lhs, "AND", rhs);
+      lhs = temporary;
+    }
+    rhs = std::make_shared<symbol_table::Immidiate>("0");
+  }
+  auto result = std::make_shared<symbol_table::Symbol>("TempResult");
+  emit.compare(compare, result, lhs, predicate, rhs);
+  jump
+      .getArgs({}, symbol_table->getPool())
+      .first()
+      .subscribe([&](sym_t::ptr::shared target) {
+        emit.branch(jump, result, target);
+      });
+}
+}  // namespace
+
+bool BranchFusion::fusable(befa::Mnemonic compare, befa::Mnemonic jump) {
+  return befa::is_jcc(jump)
+      && fused_predicate(compare, befa::condition(jump)).second;
+}
+
+void BranchFusion::operator()(
+    a_ir_t::c_info::ref compare,
+    a_ir_t::c_info::ref jump,
+    sym_table_t::ptr::shared symbol_table,
+    ir_t::rx::shared_subs subscriber
+) const {
+  ObjectEmitter emit{subscriber};
+  lift_fused(compare, jump, symbol_table, emit);
+}
+
+void BranchFusion::lift(
+    a_ir_t::c_info::ref compare,
+    a_ir_t::c_info::ref jump,
+    sym_table_t::ptr::shared symbol_table,
+    CompactFunction &function
+) const {
+  lift_fused(compare, jump, symbol_table, function);
+}
+// ~~~~~ Branch fusion
 }  // namespace llvm
 
 
@@ -0,0 +1,135 @@
+//
+// Created by miro on 10/18/26.
+//
+
+#include "../../include/befa/llvm/flags.hpp"
+#include "../../include/befa/llvm/dataflow.hpp"
+
+namespace llvm {
+
+namespace {
+using symbol_table::RegisterId;
+
+constexpr std::pair<flag_e, RegisterId> flag_registers[] = {
+    {CF, RegisterId::_cf},
+    {PF, RegisterId::_pf},
+    {ZF, RegisterId::_zf},
+    {SF, RegisterId::_sf},
+    {OF, RegisterId::_of},
+};
+
+/**
+ * @return set of flag registers (@see register_bit) of mask
+ */
+BitVector flag_set(uint8_t mask) {
+  BitVector set(register_bits);
+  for (auto &flag : flag_registers)
+    if (mask & flag.first)
+      set.set(register_bit(flag.second));
+  return set;
+}
+
+uint8_t flag_mask(const BitVector &set) {
+  uint8_t mask = 0;
+  for (auto &flag : flag_registers)
+    if (set.test(register_bit(flag.second)))
+      mask |= flag.first;
+  return mask;
+}
+
+/**
+ * Backward liveness of flags, all of them are live on unknown exits
+ */
+struct FlagLiveness
+    : public GenKillProblem<UnionMeet, BACKWARD> {
+  explicit FlagLiveness(
+      const FlowGraph &graph
+  ) : GenKillProblem(graph.blocks.size(), register_bits)
+    , graph(graph) {
+    outside = flag_set(ALL_FLAGS);
+  }
+
+  void boundary(uint32_t block, BitVector &value) const {
+    if (graph.blocks[block].unknown_exit)
+      value = outside;
+    else
+      value.fill(false);
+  }
+
+  const FlowGraph &graph;
+};
+}  // namespace
+
+uint8_t flags_read(befa::Mnemonic mnemonic) {
+  using befa::MnemonicInfo;
+  if (!(befa::details::categories(mnemonic)
+      & (MnemonicInfo::JCC | MnemonicInfo::CMOV | MnemonicInfo::SETCC)))
+    return 0;
+
+  switch (befa::condition(mnemonic)) {
+    case befa::Condition::o:
+    case befa::Condition::no:
+      return OF;
+    case befa::Condition::b:
+    case befa::Condition::ae:
+      return CF;
+    case befa::Condition::e:
+    case befa::Condition::ne:
+      return ZF;
+    case befa::Condition::be:
+    case befa::Condition::a:
+      return CF | ZF;
+    case befa::Condition::s:
+    case befa::Condition::ns:
+      return SF;
+    case befa::Condition::p:
+    case befa::Condition::np:
+      return PF;
+    case befa::Condition::l:
+    case befa::Condition::ge:
+      return SF | OF;
+    // JumpFactory tests CF for these too
+    case befa::Condition::le:
+    case befa::Condition::g:
+      return CF | ZF | SF | OF;
+    default:
+      return 0;
+  }
+}
+
+uint8_t flags_defined(befa::Mnemonic mnemonic) {
+  return mnemonic == befa::Mnemonic::_cmp || mnemonic == befa::Mnemonic::_test
+         ? (uint8_t) ALL_FLAGS : (uint8_t) 0;
+}
+
+std::vector<uint8_t> flag_liveness(
+    const FlowGraph::a_ir_t::vector::value &function,
+    const FlowGraph &graph
+) {
+  auto &blocks = graph.blocks;
+  // read before being defined / defined in block
+  FlagLiveness problem(graph);
+  for (size_t b = 0; b < blocks.size(); ++b) {
+    uint8_t used = 0, defined = 0;
+    for (uint32_t i = blocks[b].begin; i < blocks[b].end; ++i) {
+      auto mnemonic = function[i].getMnemonicId();
+      used |= flags_read(mnemonic) & ~defined;
+      defined |= flags_defined(mnemonic);
+    }
+    problem.gen[b] = flag_set(used);
+    problem.kill[b] = flag_set(defined);
+  }
+  auto solution = solve_dataflow(graph, problem);
+
+  std::vector<uint8_t> live_after(function.size(), 0);
+  for (size_t b = 0; b < blocks.size(); ++b) {
+    uint8_t live = flag_mask(solution.out[b]);
+    for (uint32_t i = blocks[b].end; i-- > blocks[b].begin;) {
+      live_after[i] = live;
+      auto mnemonic = function[i].getMnemonicId();
+      live = (live & ~flags_defined(mnemonic)) | flags_read(mnemonic);
+    }
+  }
+  return live_after;
+}
+}  // namespace llvm
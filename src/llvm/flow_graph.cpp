@@ -0,0 +1,165 @@
+//
+// Created by miro on 10/18/26.
+//
+
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <unordered_map>
+
+#include "../../include/befa/llvm/flow_graph.hpp"
+
+namespace llvm {
+
+namespace {
+/**
+ * @return true if some word of decoded text is jump or return, while
+ *         mnemonic of instruction is not (eg. behind unknown prefix)
+ */
+bool hidden_control_flow(FlowGraph::a_ir_t::c_info::ref instruction) {
+  auto mnemonic = instruction.getMnemonicId();
+  if (befa::is_jcc(mnemonic) || befa::is_jmp(mnemonic)
+      || befa::is_ret(mnemonic))
+    return false;
+  std::string_view text(instruction.getDecoded());
+  for (size_t begin = 0; begin < text.size();) {
+    size_t end = begin;
+    while (end < text.size() && std::isalnum((unsigned char) text[end]))
+      ++end;
+    auto word = befa::find_mnemonic(text.substr(begin, end - begin));
+    if (befa::is_jcc(word) || befa::is_jmp(word) || befa::is_ret(word))
+      return true;
+    // next word begins after space
+    begin = text.find(' ', end);
+    begin = text.find_first_not_of(' ', begin);
+  }
+  return false;
+}
+}  // namespace
+
+bfd_vma jump_target(FlowGraph::a_ir_t::c_info::ref instruction) {
+  auto mnemonic = instruction.getMnemonicId();
+  if (!befa::is_jcc(mnemonic) && !befa::is_jmp(mnemonic))
+    return (bfd_vma) -1;
+
+  // "jne    0x400500 <main+0x20>", "bnd jmp 0x400500 <main+0x20>"
+  auto text = befa::skip_prefixes(instruction.getDecoded());
+  size_t begin = text.find_first_of(" \t");
+  begin = text.find_first_not_of(" \t", begin);
+  if (begin == std::string_view::npos
+      || text.compare(begin, 2, "0x") != 0)
+    return (bfd_vma) -1;
+  text.remove_prefix(begin + 2);
+
+  uint64_t target = 0;
+  auto result = std::from_chars(
+      text.data(), text.data() + text.size(), target, 16
+  );
+  return result.ec == std::errc() ? (bfd_vma) target : (bfd_vma) -1;
+}
+
+FlowGraph::FlowGraph(const a_ir_t::vector::value &function) {
+  auto count = (uint32_t) function.size();
+  std::unordered_map<bfd_vma, uint32_t> indices;
+  indices.reserve(count);
+  for (uint32_t i = 0; i < count; ++i)
+    indices.emplace(function[i].getAddress(), i);
+
+  // ~~~~~ Leaders
+  std::vector<bool> leader(count + 1, false);
+  std::vector<uint32_t> targets(count, (uint32_t) -1);
+  // instructions that leaves block in a way we can't tell
+  std::vector<bool> hidden(count, false);
+  leader[0] = true;
+  for (uint32_t i = 0; i < count; ++i) {
+    auto mnemonic = function[i].getMnemonicId();
+    hidden[i] = hidden_control_flow(function[i]);
+    if (befa::is_jcc(mnemonic) || befa::is_jmp(mnemonic)
+        || befa::is_ret(mnemonic) || hidden[i])
+      leader[i + 1] = true;
+    auto target = indices.find(jump_target(function[i]));
+    if (target != indices.end()) {
+      targets[i] = target->second;
+      leader[target->second] = true;
+    }
+  }
+  std::vector<uint32_t> block_of(count);
+  for (uint32_t i = 0; i < count; ++i) {
+    if (leader[i])
+      blocks.push_back(Block{i, i, {}, {}});
+    block_of[i] = (uint32_t) blocks.size() - 1;
+    blocks.back().end = i + 1;
+  }
+  // ~~~~~ Leaders
+
+  // ~~~~~ Edges
+  for (uint32_t b = 0; b < blocks.size(); ++b) {
+    Block &block = blocks[b];
+    uint32_t last = block.end - 1;
+    auto mnemonic = function[last].getMnemonicId();
+    if (befa::is_ret(mnemonic))
+      continue;
+    // could be anything, falling through included
+    if (hidden[last])
+      block.unknown_exit = true;
+    if (befa::is_jcc(mnemonic) || befa::is_jmp(mnemonic)) {
+      if (targets[last] != (uint32_t) -1)
+        block.successors.push_back(block_of[targets[last]]);
+      else
+        block.unknown_exit = true;
+      if (befa::is_jmp(mnemonic))
+        continue;
+    }
+    if (block.end < count)
+      block.successors.push_back(b + 1);
+    else
+      block.unknown_exit = true;
+  }
+  for (uint32_t b = 0; b < blocks.size(); ++b) {
+    auto &successors = blocks[b].successors;
+    std::sort(successors.begin(), successors.end());
+    successors.erase(
+        std::unique(successors.begin(), successors.end()), successors.end()
+    );
+    for (auto successor : successors)
+      blocks[successor].predecessors.push_back(b);
+  }
+  // ~~~~~ Edges
+
+  // ~~~~~ Reverse postorder (iterative DFS)
+  if (blocks.empty())
+    return;
+  std::vector<bool> visited(blocks.size(), false);
+  std::vector<std::pair<uint32_t, size_t>> stack{{0, 0}};
+  visited[0] = true;
+  while (!stack.empty()) {
+    auto &top = stack.back();
+    auto &successors = blocks[top.first].successors;
+    if (top.second < successors.size()) {
+      uint32_t next = successors[top.second++];
+      if (!visited[next]) {
+        visited[next] = true;
+        stack.emplace_back(next, 0);
+      }
+      continue;
+    }
+    order.push_back(top.first);
+    stack.pop_back();
+  }
+  std::reverse(order.begin(), order.end());
+  for (uint32_t b = 0; b < blocks.size(); ++b)
+    if (!visited[b])
+      order.push_back(b);
+  // ~~~~~ Reverse postorder
+}
+
+uint32_t FlowGraph::blockOf(uint32_t instruction) const {
+  auto block = std::upper_bound(
+      blocks.begin(), blocks.end(), instruction,
+      [](uint32_t instruction, const Block &block) {
+        return instruction < block.begin;
+      }
+  );
+  return (uint32_t) (block - blocks.begin()) - 1;
+}
+}  // namespace llvm
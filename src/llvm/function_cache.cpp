@@ -0,0 +1,430 @@
+//
+// Created by miro on 10/18/26.
+//
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+#include "../../include/befa/llvm/function_cache.hpp"
+#include "../../include/befa/llvm/call.hpp"
+#include "../../include/befa/llvm/cmp.hpp"
+#include "../../include/befa/llvm/jmp.hpp"
+
+namespace llvm {
+
+namespace details {
+/**
+ * Rebuilds lifted instruction for another assembly instruction
+ * (assembly == nullptr only checks if instruction can be rebuilt)
+ *
+ * Symbols of visited instruction are collected into symbols.
+ */
+struct RebaseVisitor
+    : public VisitorBase {
+  using a_ir_t = traits::a_ir;
+  using ir_t = traits::ir;
+  using VisitorBase::visit;
+
+  RebaseVisitor(
+      const a_ir_t::info::type *assembly
+  ) : assembly(assembly) {}
+
+  IMPLEMENT_VISIT(CallInstruction, call) {
+    known = true;
+    symbols = {call->getDefinitions()[0], call->getUsedSymbols()[0]};
+    if (assembly)
+      result = std::make_shared<CallInstruction>(
+          a_ir_t::vector::value{*assembly},
+          call->getDefinitions()[0], call->getUsedSymbols()[0]
+      );
+  }
+
+  IMPLEMENT_VISIT(CmpInstruction, cmp) {
+    known = true;
+    auto args = cmp->getUsedSymbols();
+    symbols = {cmp->getAssignee(), args[0], args[1]};
+    if (assembly) {
+      result = std::make_shared<CmpInstruction>(
+          *assembly, cmp->getAssignee(), args[0], cmp->getPredicate(), args[1]
+      );
+    }
+  }
+
+  IMPLEMENT_VISIT(BranchInstruction, branch) {
+    known = true;
+    symbols = branch->getUsedSymbols();
+    if (assembly)
+      result = std::make_shared<BranchInstruction>(
+          a_ir_t::vector::value{*assembly},
+          branch->getCondition(), branch->getTarget()
+      );
+  }
+
+  IMPLEMENT_VISIT(UnaryInstruction, unary) {
+    known = true;
+    symbols = {unary->getAssignee(), unary->getUsedSymbols()[0]};
+    if (assembly)
+      result = std::make_shared<UnaryInstruction>(
+          a_ir_t::vector::value{*assembly}, unary->getAssignee(),
+          unary->getOperator(), unary->getUsedSymbols()[0]
+      );
+  }
+
+  IMPLEMENT_VISIT(BinaryOperation, binary) {
+    known = true;
+    auto args = binary->getUsedSymbols();
+    symbols = {binary->getAssignee(), args[0], args[1]};
+    if (assembly) {
+      result = std::make_shared<BinaryOperation>(
+          a_ir_t::vector::value{*assembly}, binary->getAssignee(),
+          args[0], binary->getOperator(), args[1]
+      );
+    }
+  }
+
+  const a_ir_t::info::type *assembly;
+  ir_t::ptr::shared result;
+  Instruction::sym_t::vector::shared symbols;
+  bool known = false;
+};
+
+/**
+ * Finds out if symbol references function (address in this binary)
+ */
+struct FunctionFinder
+    : public symbol_table::TemporaryVisitor {
+  using symbol_table::TemporaryVisitor::visit;
+
+  IMPLEMENT_VISIT(symbol_table::Function, function) {
+    found = true;
+  }
+
+  IMPLEMENT_VISIT(symbol_table::Temporary, temporary) {
+    generalized_visitor(temporary);
+  }
+
+  void generalized_visitor(const symbol_table::Temporary *temporary) override {
+    if (temporary->getLeft())
+      temporary->getLeft()->accept(*this);
+    if (temporary->getRight())
+      temporary->getRight()->accept(*this);
+  }
+
+  bool found = false;
+};
+
+bool references_function(const Instruction::sym_t::vector::shared &symbols) {
+  FunctionFinder finder;
+  for (auto &symbol : symbols)
+    if (symbol)
+      symbol->accept(finder);
+  return finder.found;
+}
+
+/**
+ * Finds field of instruction that encodes target (relative to the next
+ * instruction or absolute), opcode byte is never part of it
+ *
+ * @return offset and size of field, size is 0 if there is none
+ */
+std::pair<size_t, size_t> address_field(
+    const uint8_t *bytes,
+    size_t size,
+    bfd_vma address,
+    bfd_vma target
+) {
+  uint64_t relative = target - (address + size);
+  // little-endian encodings, wider ones first (rel8 matches too often)
+  const struct {
+    uint64_t value;
+    size_t size;
+    bool fits;
+  } encodings[] = {
+      {relative, 4, (int64_t) relative == (int32_t) relative},
+      {target, 4, true},
+      {target, 8, true},
+      {relative, 1, (int64_t) relative == (int8_t) relative},
+  };
+  for (auto &encoding : encodings) {
+    if (!encoding.fits)
+      continue;
+    for (size_t offset = 1; offset + encoding.size <= size; ++offset) {
+      size_t i = 0;
+      while (i < encoding.size
+          && bytes[offset + i] == (uint8_t) (encoding.value >> (i * 8)))
+        ++i;
+      if (i == encoding.size)
+        return {offset, encoding.size};
+    }
+  }
+  return {0, 0};
+}
+}  // namespace details
+
+// ~~~~~ Hasher
+FunctionCache::Hasher::Hasher(
+    uint32_t arch,
+    uint64_t machine,
+    std::string_view options
+) {
+  for (size_t shift = 0; shift < sizeof(arch); shift += 1)
+    feed((uint8_t) (arch >> (shift * 8)));
+  for (size_t shift = 0; shift < sizeof(machine); shift += 1)
+    feed((uint8_t) (machine >> (shift * 8)));
+  for (char c : options)
+    feed((uint8_t) c);
+  feed(0);
+}
+
+void FunctionCache::Hasher::add(
+    const uint8_t *bytes,
+    size_t size,
+    bool relocatable,
+    bfd_vma address,
+    bfd_vma target
+) {
+  // masked field is address (rel32, disp32, ...), opcode stays
+  std::pair<size_t, size_t> masked{size, 0};
+  if (relocatable) {
+    masked = details::address_field(bytes, size, address, target);
+    if (!masked.second) {
+      masked.second = std::min<size_t>(4, size ? size - 1 : 0);
+      masked.first = size - masked.second;
+    }
+  }
+  for (size_t shift = 0; shift < sizeof(size); shift += 1)
+    feed((uint8_t) (size >> (shift * 8)));
+  feed((uint8_t) relocatable);
+  feed((uint8_t) masked.first);
+  for (size_t i = 0; i < size; ++i)
+    if (i - masked.first >= masked.second)
+      feed(bytes[i]);
+}
+// ~~~~~ Hasher
+
+// ~~~~~ Function cache
+FunctionCache::entry_t::c_ptr::shared FunctionCache::find(hash_t hash) {
+  {
+    std::lock_guard<std::mutex> guard(lock);
+    auto ite = entries.find(hash);
+    if (ite != entries.end())
+      return ite->second;
+  }
+  if (directory.empty())
+    return nullptr;
+
+  auto loaded = load(hash);
+  if (!loaded)
+    return nullptr;
+  std::lock_guard<std::mutex> guard(lock);
+  // someone could be faster
+  return entries.emplace(hash, loaded).first->second;
+}
+
+void FunctionCache::insert(hash_t hash, Entry entry) {
+  auto stored = std::make_shared<const Entry>(std::move(entry));
+  {
+    std::lock_guard<std::mutex> guard(lock);
+    entries[hash] = stored;
+  }
+  if (!directory.empty())
+    store(hash, *stored);
+}
+
+void FunctionCache::insert_lifted(
+    hash_t hash,
+    lifted_t lifted,
+    const std::vector<uint32_t> &relift
+) {
+  std::lock_guard<std::mutex> guard(lock);
+  auto ite = entries.find(hash);
+  if (ite == entries.end() || ite->second->has_lifted)
+    return;
+
+  // entries are shared, so lifted one is a new copy
+  auto entry = std::make_shared<Entry>(*ite->second);
+  std::stable_sort(
+      lifted.begin(), lifted.end(),
+      [](const auto &lhs, const auto &rhs) { return lhs.first < rhs.first; }
+  );
+  entry->lifted = std::move(lifted);
+  entry->relift = relift;
+  std::sort(entry->relift.begin(), entry->relift.end());
+  entry->has_lifted = true;
+  ite->second = entry;
+}
+
+size_t FunctionCache::size() const {
+  std::lock_guard<std::mutex> guard(lock);
+  return entries.size();
+}
+
+FunctionCache::ir_t::ptr::shared FunctionCache::rebase(
+    const ir_t::ptr::shared &instruction,
+    a_ir_t::c_info::ref assembly
+) {
+  details::RebaseVisitor visitor(&assembly);
+  instruction->accept(visitor);
+  return visitor.result;
+}
+
+std::string FunctionCache::path(hash_t hash) const {
+  std::stringstream ss;
+  ss << directory << "/" << std::hex << std::setw(16) << std::setfill('0')
+     << hash << ".bfc";
+  return ss.str();
+}
+
+/**
+ * File format (text):
+ *  befa-function-cache 1
+ *  <count>
+ *  <offset> <size> <relocatable> <jump> <length>:<decoded>
+ */
+static const std::string cache_magic = "befa-function-cache";
+static const int cache_version = 1;
+
+FunctionCache::entry_t::c_ptr::shared FunctionCache::load(hash_t hash) const {
+  std::ifstream input(path(hash));
+  if (!input)
+    return nullptr;
+
+  std::string magic;
+  int version;
+  size_t count;
+  if (!(input >> magic >> version >> count)
+      || magic != cache_magic || version != cache_version)
+    return nullptr;
+
+  Entry entry;
+  entry.instructions.reserve(count);
+  for (size_t i = 0; i < count; ++i) {
+    CachedInstruction instruction{};
+    size_t length;
+    char separator;
+    if (!(input >> instruction.offset >> instruction.size
+                >> instruction.relocatable >> instruction.jump
+                >> length) || !input.get(separator) || separator != ':')
+      return nullptr;
+    instruction.decoded.resize(length);
+    if (!input.read(&instruction.decoded[0], length))
+      return nullptr;
+    entry.instructions.push_back(std::move(instruction));
+  }
+  return std::make_shared<const Entry>(std::move(entry));
+}
+
+void FunctionCache::store(hash_t hash, const Entry &entry) const {
+  std::string file = path(hash);
+  std::string temporary = file + ".tmp";
+  {
+    std::ofstream output(temporary);
+    if (!output)
+      return;
+    output << cache_magic << " " << cache_version << "\n"
+           << entry.instructions.size() << "\n";
+    for (auto &instruction : entry.instructions)
+      output << instruction.offset << " " << instruction.size << " "
+             << instruction.relocatable << " " << instruction.jump << " "
+             << instruction.decoded.size() << ":" << instruction.decoded
+             << "\n";
+    if (!output)
+      return;
+  }
+  // readers see either old file or complete new one
+  std::rename(temporary.c_str(), file.c_str());
+}
+// ~~~~~ Function cache
+
+// ~~~~~ Cache session
+CacheSession::Function CacheSession::function_of(
+    a_ir_t::c_info::ref instruction
+) {
+  if (!instruction.hasParent())
+    return Function();
+  auto symbol = ptr_lock(instruction.getParent()->getParent());
+  return Function{
+      symbol.get(), symbol->getAddress(), symbol->getContentHash()
+  };
+}
+
+void CacheSession::begin(const Function &function) {
+  if (function.identity == this->function.identity)
+    return;
+
+  finish();
+  this->function = function;
+  entry = function.hash ? cache->find(function.hash) : nullptr;
+  // without decoded entry there is no way to find out relocations
+  recording = entry && !entry->instructions.empty() && !entry->has_lifted;
+}
+
+bool CacheSession::replay(
+    a_ir_t::c_info::ref instruction,
+    ir_t::rx::shared_subs subscriber
+) {
+  capturing = false;
+  if (!entry)
+    return false;
+
+  offset = (uint32_t) (instruction.getAddress() - function.address);
+  auto cached = std::lower_bound(
+      entry->instructions.begin(), entry->instructions.end(), offset,
+      [](const FunctionCache::CachedInstruction &cached, uint32_t offset) {
+        return cached.offset < offset;
+      }
+  );
+  if (cached == entry->instructions.end() || cached->offset != offset)
+    return false;
+
+  if (recording) {
+    capturing = !cached->relocatable;
+    return false;
+  }
+
+  if (!entry->has_lifted || cached->relocatable
+      || std::binary_search(entry->relift.begin(), entry->relift.end(), offset))
+    return false;
+
+  auto range = std::equal_range(
+      entry->lifted.begin(), entry->lifted.end(),
+      std::make_pair(offset, ir_t::ptr::shared()),
+      [](const auto &lhs, const auto &rhs) { return lhs.first < rhs.first; }
+  );
+  for (auto ite = range.first; ite != range.second; ++ite)
+    subscriber.on_next(FunctionCache::rebase(ite->second, instruction));
+  return true;
+}
+
+void CacheSession::record(const ir_t::ptr::shared &instruction) {
+  if (!recording || !capturing)
+    return;
+
+  details::RebaseVisitor visitor(nullptr);
+  instruction->accept(visitor);
+  // one unknown instruction makes whole function unusable
+  if (!visitor.known) {
+    recording = false;
+    return;
+  }
+
+  if (details::references_function(visitor.symbols)
+      && (relift.empty() || relift.back() != offset))
+    relift.push_back(offset);
+  lifted.emplace_back(offset, instruction);
+}
+
+void CacheSession::finish() {
+  if (recording)
+    cache->insert_lifted(function.hash, std::move(lifted), relift);
+  lifted.clear();
+  relift.clear();
+  function = Function();
+  entry = nullptr;
+  recording = capturing = false;
+}
+// ~~~~~ Cache session
+}  // namespace llvm
@@ -0,0 +1,180 @@
+//
+// Created by miro on 10/18/26.
+//
+
+#include "../../include/befa/llvm/ir_writer.hpp"
+#include "../../include/befa/llvm/call.hpp"
+#include "../../include/befa/llvm/jmp.hpp"
+
+namespace llvm {
+
+namespace {
+/**
+ * @return name of symbol, empty if it is not symbol
+ *         (@see details::fetch_name)
+ */
+std::string_view name_of(const IrWriter::sym_t::ptr::shared &symbol) {
+  auto named = dynamic_cast<const symbol_table::Symbol *>(symbol.get());
+  return named ? std::string_view(named->getName()) : std::string_view();
+}
+}  // namespace
+
+/**
+ * Writes known instructions piece by piece, the rest by toString()
+ */
+struct IrWriter::Visitor
+    : public SerializableVisitor {
+  using SerializableVisitor::visit;
+
+  explicit Visitor(
+      IrWriter &writer
+  ) : writer(writer) {}
+
+  IMPLEMENT_VISIT(BinaryOperation, binary) {
+    auto args = binary->getUsedSymbols();
+    writer.writeSymbol(binary->getAssignee());
+    writer.sink << " = ";
+    writer.write_result(args[0], binary->getOperator(), args[1]);
+    written = true;
+  }
+
+  IMPLEMENT_VISIT(UnaryInstruction, unary) {
+    writer.writeSymbol(unary->getAssignee());
+    writer.sink << " = ";
+    writer.write_result(
+        nullptr, unary->getOperator(), unary->getUsedSymbols()[0]
+    );
+    written = true;
+  }
+
+  IMPLEMENT_VISIT(CmpInstruction, cmp) {
+    auto args = cmp->getUsedSymbols();
+    writer.writeSymbol(cmp->getAssignee());
+    writer.sink << " = icmp " << cmp->getOperator() << ' ';
+    writer.writeSymbol(args[0]);
+    writer.sink << ", ";
+    writer.writeSymbol(args[1]);
+    written = true;
+  }
+
+  IMPLEMENT_VISIT(CallInstruction, call) {
+    writer.writeSymbol(call->getDefinitions()[0]);
+    writer.sink << " = " << call->getOperator() << ' ';
+    writer.writeSymbol(call->getUsedSymbols()[0]);
+    writer.sink << "()";
+    written = true;
+  }
+
+  IMPLEMENT_VISIT(BranchInstruction, branch) {
+    writer.sink << "br ";
+    writer.writeSymbol(branch->getCondition());
+    writer.sink << ", address ";
+    writer.writeSymbol(branch->getTarget());
+    written = true;
+  }
+
+  void generalized_visitor(const Serializable *serializable) override {
+    writer.sink << serializable->toString();
+    written = true;
+  }
+
+  IrWriter &writer;
+  bool written = false;
+};
+
+void IrWriter::write(const ir_t::ptr::shared &instruction) {
+  if (!instruction)
+    return;
+  Visitor visitor(*this);
+  instruction->accept(visitor);
+  // base classes, that are not visited by SerializableVisitor
+  if (!visitor.written)
+    if (auto serializable = dynamic_cast<const Serializable *>(
+        instruction.get()
+    ))
+      sink << serializable->toString();
+}
+
+void IrWriter::write(const CompactFunction &function, size_t index) {
+  auto &record = function.record(index);
+  auto operand = [&function, &record](size_t i) {
+    return record.operands[i] == CompactFunction::no_value
+           ? sym_t::ptr::shared() : function.value(record.operands[i]);
+  };
+  switch (record.kind) {
+    case CompactFunction::BINARY:
+      writeSymbol(operand(0));
+      sink << " = ";
+      write_result(operand(1), function.getOperator(record), operand(2));
+      break;
+    case CompactFunction::UNARY:
+      writeSymbol(operand(0));
+      sink << " = ";
+      write_result(nullptr, function.getOperator(record), operand(1));
+      break;
+    case CompactFunction::COMPARE:
+      writeSymbol(operand(0));
+      sink << " = icmp " << CmpInstruction::predicateName(
+          (CmpInstruction::types_e) record.predicate
+      ) << ' ';
+      writeSymbol(operand(1));
+      sink << ", ";
+      writeSymbol(operand(2));
+      break;
+    case CompactFunction::CALL:
+      writeSymbol(operand(0));
+      sink << " = " << CallInstruction::an_operator << ' ';
+      writeSymbol(operand(1));
+      sink << "()";
+      break;
+    case CompactFunction::BRANCH:
+      sink << "br ";
+      writeSymbol(operand(0));
+      sink << ", address ";
+      writeSymbol(operand(1));
+      break;
+    default:
+      write(function.view(index));
+      break;
+  }
+}
+
+void IrWriter::write(const CompactFunction &function) {
+  for (size_t index = 0; index < function.size(); ++index) {
+    write(function, index);
+    sink.put('\n');
+  }
+}
+
+void IrWriter::writeAssembly(const Instruction &instruction) {
+  sink << "_asm {\n";
+  for (auto &assembly : instruction.getAssembly())
+    sink << '\t' << assembly.getMnemonic() << '\n';
+  sink << "}\n";
+}
+
+void IrWriter::writeSymbol(const sym_t::ptr::shared &symbol) {
+  sink << name_of(symbol);
+}
+
+void IrWriter::write_result(
+    const sym_t::ptr::shared &lhs,
+    std::string_view op,
+    const sym_t::ptr::shared &rhs
+) {
+  // the same as Temporary::fetchName
+  auto lhs_name = name_of(lhs);
+  if (lhs_name.empty() && !op.empty()) {
+    sink << op << '(';
+    writeSymbol(rhs);
+    sink << ')';
+  } else if (!op.empty()) {
+    sink << '(' << lhs_name << ") " << op << " (";
+    writeSymbol(rhs);
+    sink << ')';
+  } else {
+    sink << lhs_name;
+    writeSymbol(rhs);
+  }
+}
+}  // namespace llvm
@@ -0,0 +1,408 @@
+//
+// Created by miro on 10/18/26.
+//
+
+#include <string>
+#include <unordered_map>
+
+#include "../../include/befa/llvm/ssa.hpp"
+
+namespace llvm {
+
+namespace {
+constexpr uint32_t none = (uint32_t) -1;
+
+/**
+ * Groups second of pairs by first (counting sort, keeps their order)
+ *
+ * Group k is grouped[begin[k], begin[k + 1])
+ */
+void group(
+    size_t keys,
+    const std::vector<std::pair<uint32_t, uint32_t>> &pairs,
+    std::vector<uint32_t> &begin,
+    std::vector<uint32_t> &grouped
+) {
+  begin.assign(keys + 1, 0);
+  for (auto &pair : pairs)
+    ++begin[pair.first + 1];
+  for (size_t key = 0; key < keys; ++key)
+    begin[key + 1] += begin[key];
+  grouped.resize(pairs.size());
+  std::vector<uint32_t> next(begin.begin(), begin.end() - 1);
+  for (auto &pair : pairs)
+    grouped[next[pair.first]++] = pair.second;
+}
+}  // namespace
+
+SsaForm::SsaForm(
+    const a_ir_t::vector::value &function,
+    const CompactFunction &lifted
+) : flow(function) {
+  assert_ex(lifted.size() == 0 || !flow.blocks.empty(),
+            "lifted records without instructions of function");
+
+  // ~~~~~ Variables of records
+  std::unordered_map<bfd_vma, uint32_t> instruction_of;
+  instruction_of.reserve(function.size());
+  for (uint32_t i = 0; i < function.size(); ++i)
+    instruction_of.emplace(function[i].getAddress(), i);
+
+  std::unordered_map<std::string, uint32_t> variable_ids;
+  auto variable_of = [this, &variable_ids](const sym_t::ptr::shared &value) {
+    auto symbol = dynamic_cast<const symbol_table::Symbol *>(value.get());
+    if (!symbol
+        || dynamic_cast<const symbol_table::Immidiate *>(symbol)
+        || dynamic_cast<const symbol_table::Function *>(symbol))
+      return none;
+    auto inserted = variable_ids.emplace(
+        symbol->getName(), (uint32_t) variables.size()
+    );
+    if (inserted.second)
+      variables.push_back(value);
+    return inserted.first->second;
+  };
+  // values of compact function are resolved once
+  std::vector<uint32_t> compact_variables(lifted.valueCount(), none - 1);
+  auto compact_variable = [&](CompactFunction::value_id id) {
+    if (id == CompactFunction::no_value)
+      return none;
+    if (compact_variables[id] == none - 1)
+      compact_variables[id] = variable_of(lifted.value(id));
+    return compact_variables[id];
+  };
+
+  record_block.reserve(lifted.size());
+  record_defs_begin.assign(1, 0);
+  record_uses_begin.assign(1, 0);
+  auto define = [this](uint32_t variable) {
+    if (variable != none)
+      record_defs.push_back(variable);
+  };
+  auto use = [this](uint32_t variable) {
+    if (variable != none)
+      record_uses.push_back(variable);
+  };
+  uint32_t block = 0;
+  for (size_t index = 0; index < lifted.size(); ++index) {
+    auto &record = lifted.record(index);
+    if (record.kind == CompactFunction::OPAQUE) {
+      // belongs to block of previous record
+      auto instruction = lifted.view(index);
+      if (auto user = dynamic_cast<const User *>(instruction.get()))
+        for (auto &symbol : user->getUsedSymbols())
+          use(variable_of(symbol));
+      if (auto definer = dynamic_cast<const Definer *>(instruction.get()))
+        for (auto &symbol : definer->getDefinitions())
+          define(variable_of(symbol));
+    } else {
+      auto found = instruction_of.find(lifted.getAssembly(record).getAddress());
+      if (found != instruction_of.end())
+        block = flow.blockOf(found->second);
+      bool defines = record.kind != CompactFunction::BRANCH;
+      for (size_t operand = defines ? 1 : 0; operand < 3; ++operand)
+        use(compact_variable(record.operands[operand]));
+      if (defines)
+        define(compact_variable(record.operands[0]));
+    }
+    record_block.push_back(block);
+    record_defs_begin.push_back((uint32_t) record_defs.size());
+    record_uses_begin.push_back((uint32_t) record_uses.size());
+  }
+  // ~~~~~ Variables of records
+
+  compute_dominators();
+  place_phis();
+  rename();
+  link_uses();
+}
+
+void SsaForm::compute_dominators() {
+  auto &blocks = flow.blocks;
+  auto &order = flow.reversePostorder();
+  idom.assign(blocks.size(), none);
+  if (blocks.empty())
+    return;
+
+  std::vector<uint32_t> position(blocks.size());
+  for (uint32_t i = 0; i < order.size(); ++i)
+    position[order[i]] = i;
+  auto intersect = [this, &position](uint32_t a, uint32_t b) {
+    while (a != b) {
+      while (position[a] > position[b])
+        a = idom[a];
+      while (position[b] > position[a])
+        b = idom[b];
+    }
+    return a;
+  };
+
+  idom[order[0]] = order[0];
+  for (bool changed = true; changed;) {
+    changed = false;
+    for (size_t i = 1; i < order.size(); ++i) {
+      uint32_t b = order[i];
+      uint32_t dominator = none;
+      for (auto predecessor : blocks[b].predecessors)
+        if (idom[predecessor] != none)
+          dominator = dominator == none
+                      ? predecessor : intersect(predecessor, dominator);
+      if (dominator != none && idom[b] != dominator) {
+        idom[b] = dominator;
+        changed = true;
+      }
+    }
+  }
+}
+
+void SsaForm::compute_frontiers(
+    std::vector<uint32_t> &begin,
+    std::vector<uint32_t> &frontier
+) const {
+  auto &blocks = flow.blocks;
+  std::vector<std::pair<uint32_t, uint32_t>> edges;
+  std::vector<uint32_t> added(blocks.size(), none);
+  for (uint32_t b = 0; b < blocks.size(); ++b) {
+    auto &predecessors = blocks[b].predecessors;
+    // entry has one more edge from outside of function
+    bool entry = b == 0;
+    if (idom[b] == none || predecessors.size() + entry < 2)
+      continue;
+    uint32_t stop = entry ? none : idom[b];
+    for (auto runner : predecessors) {
+      if (idom[runner] == none)
+        continue;
+      while (runner != stop) {
+        if (added[runner] != b) {
+          added[runner] = b;
+          edges.emplace_back(runner, b);
+        }
+        if (runner == 0)
+          break;
+        runner = idom[runner];
+      }
+    }
+  }
+  group(blocks.size(), edges, begin, frontier);
+}
+
+void SsaForm::place_phis() {
+  auto &blocks = flow.blocks;
+  size_t count = variables.size();
+
+  // ~~~~~ Blocks defining variables, variables read across blocks
+  std::vector<bool> global(count, false);
+  std::vector<uint32_t> defined(count, none);
+  std::vector<std::pair<uint32_t, uint32_t>> sites;
+  for (size_t index = 0; index < record_block.size(); ++index) {
+    uint32_t block = record_block[index];
+    for (auto k = record_uses_begin[index]; k < record_uses_begin[index + 1]; ++k)
+      if (defined[record_uses[k]] != block)
+        global[record_uses[k]] = true;
+    for (auto k = record_defs_begin[index]; k < record_defs_begin[index + 1]; ++k)
+      if (defined[record_defs[k]] != block) {
+        defined[record_defs[k]] = block;
+        sites.emplace_back(record_defs[k], block);
+      }
+  }
+  std::vector<uint32_t> sites_begin, site_blocks;
+  group(count, sites, sites_begin, site_blocks);
+  // ~~~~~ Blocks defining variables
+
+  // ~~~~~ Iterated dominance frontiers
+  std::vector<uint32_t> frontier_begin, frontier;
+  compute_frontiers(frontier_begin, frontier);
+
+  std::vector<std::pair<uint32_t, uint32_t>> placed;
+  std::vector<uint32_t> has_phi(blocks.size(), none);
+  std::vector<uint32_t> queued(blocks.size(), none);
+  std::vector<uint32_t> work;
+  for (uint32_t variable = 0; variable < count; ++variable) {
+    if (!global[variable])
+      continue;
+    for (auto k = sites_begin[variable]; k < sites_begin[variable + 1]; ++k) {
+      queued[site_blocks[k]] = variable;
+      work.push_back(site_blocks[k]);
+    }
+    while (!work.empty()) {
+      uint32_t block = work.back();
+      work.pop_back();
+      for (auto k = frontier_begin[block]; k < frontier_begin[block + 1]; ++k) {
+        uint32_t join = frontier[k];
+        if (has_phi[join] == variable)
+          continue;
+        has_phi[join] = variable;
+        placed.emplace_back(join, variable);
+        if (queued[join] != variable) {
+          queued[join] = variable;
+          work.push_back(join);
+        }
+      }
+    }
+  }
+  // ~~~~~ Iterated dominance frontiers
+
+  std::vector<uint32_t> phi_variables;
+  group(blocks.size(), placed, block_phis_begin, phi_variables);
+  phis.reserve(phi_variables.size());
+  phi_operands_begin.assign(1, 0);
+  for (uint32_t block = 0; block < blocks.size(); ++block)
+    for (auto k = block_phis_begin[block]; k < block_phis_begin[block + 1]; ++k) {
+      phis.push_back(Phi{block, (value_id) values.size()});
+      values.push_back(Value{phi_variables[k], PHI, k});
+      phi_operands_begin.push_back(
+          phi_operands_begin.back()
+          + (uint32_t) blocks[block].predecessors.size() + (block == 0)
+      );
+    }
+  phi_operands.assign(phi_operands_begin.back(), no_value);
+}
+
+void SsaForm::rename() {
+  auto &blocks = flow.blocks;
+  if (blocks.empty())
+    return;
+
+  // ~~~~~ Dominator tree and records of blocks
+  std::vector<std::pair<uint32_t, uint32_t>> edges;
+  for (uint32_t block = 1; block < blocks.size(); ++block)
+    if (idom[block] != none)
+      edges.emplace_back(idom[block], block);
+  std::vector<uint32_t> children_begin, children;
+  group(blocks.size(), edges, children_begin, children);
+
+  edges.clear();
+  for (uint32_t index = 0; index < record_block.size(); ++index)
+    edges.emplace_back(record_block[index], index);
+  std::vector<uint32_t> records_begin, records;
+  group(blocks.size(), edges, records_begin, records);
+  // ~~~~~ Dominator tree
+
+  // current value of variables, undo log restores them after subtree
+  std::vector<value_id> current(variables.size(), none);
+  std::vector<value_id> live_in(variables.size(), none);
+  std::vector<std::pair<uint32_t, value_id>> log;
+  auto reaching = [&](uint32_t variable) {
+    if (current[variable] != none)
+      return current[variable];
+    if (live_in[variable] == none) {
+      live_in[variable] = (value_id) values.size();
+      values.push_back(Value{variable, LIVE_IN, 0});
+    }
+    return live_in[variable];
+  };
+  auto define = [&](uint32_t variable, value_id value) {
+    log.emplace_back(variable, current[variable]);
+    current[variable] = value;
+  };
+
+  auto visit = [&](uint32_t block) {
+    for (auto p = block_phis_begin[block]; p < block_phis_begin[block + 1]; ++p)
+      define(values[phis[p].result].variable, phis[p].result);
+    for (auto r = records_begin[block]; r < records_begin[block + 1]; ++r) {
+      uint32_t index = records[r];
+      for (auto k = record_uses_begin[index]; k < record_uses_begin[index + 1]; ++k)
+        record_uses[k] = reaching(record_uses[k]);
+      for (auto k = record_defs_begin[index]; k < record_defs_begin[index + 1]; ++k) {
+        value_id value = (value_id) values.size();
+        values.push_back(Value{record_defs[k], RECORD, index});
+        record_defs[k] = value;
+        define(values[value].variable, value);
+      }
+    }
+    // operands from unreachable blocks stay no_value
+    if (block != 0 && idom[block] == none)
+      return;
+    for (auto successor : blocks[block].successors) {
+      auto &predecessors = blocks[successor].predecessors;
+      uint32_t edge = 0;
+      while (predecessors[edge] != block)
+        ++edge;
+      for (auto p = block_phis_begin[successor];
+           p < block_phis_begin[successor + 1]; ++p)
+        phi_operands[phi_operands_begin[p] + edge] =
+            reaching(values[phis[p].result].variable);
+    }
+  };
+
+  // entry phis merge values from outside of function too
+  for (auto p = block_phis_begin[0]; p < block_phis_begin[1]; ++p)
+    phi_operands[phi_operands_begin[p + 1] - 1] =
+        reaching(values[phis[p].result].variable);
+
+  // entry first, then every unreachable block as its own root
+  struct Frame {
+    uint32_t block;
+    size_t mark;
+    uint32_t child;
+  };
+  std::vector<Frame> stack;
+  for (uint32_t root = 0; root < blocks.size(); ++root) {
+    if (root != 0 && idom[root] != none)
+      continue;
+    stack.push_back(Frame{root, log.size(), children_begin[root]});
+    visit(root);
+    while (!stack.empty()) {
+      Frame &top = stack.back();
+      if (top.child < children_begin[top.block + 1]) {
+        uint32_t child = children[top.child++];
+        stack.push_back(Frame{child, log.size(), children_begin[child]});
+        visit(child);
+        continue;
+      }
+      for (; log.size() > top.mark; log.pop_back())
+        current[log.back().first] = log.back().second;
+      stack.pop_back();
+    }
+  }
+}
+
+void SsaForm::link_uses() {
+  users_begin.assign(values.size() + 1, 0);
+  for (auto value : record_uses)
+    ++users_begin[value + 1];
+  for (auto value : phi_operands)
+    if (value != no_value)
+      ++users_begin[value + 1];
+  for (size_t value = 0; value < values.size(); ++value)
+    users_begin[value + 1] += users_begin[value];
+
+  users.resize(users_begin.back());
+  std::vector<uint32_t> next(users_begin.begin(), users_begin.end() - 1);
+  for (uint32_t index = 0; index + 1 < record_uses_begin.size(); ++index)
+    for (auto k = record_uses_begin[index]; k < record_uses_begin[index + 1]; ++k)
+      users[next[record_uses[k]]++] =
+          Use{RECORD, index, k - record_uses_begin[index]};
+  for (uint32_t p = 0; p < phis.size(); ++p)
+    for (auto k = phi_operands_begin[p]; k < phi_operands_begin[p + 1]; ++k)
+      if (phi_operands[k] != no_value)
+        users[next[phi_operands[k]]++] =
+            Use{PHI, p, k - phi_operands_begin[p]};
+}
+
+// ~~~~~ Accessors
+SsaForm::use_range SsaForm::usersOf(value_id id) const {
+  return ::range(users.data() + users_begin[id],
+                 users.data() + users_begin[id + 1]);
+}
+
+SsaForm::value_range SsaForm::definedBy(size_t record) const {
+  return ::range(record_defs.data() + record_defs_begin[record],
+                 record_defs.data() + record_defs_begin[record + 1]);
+}
+
+SsaForm::value_range SsaForm::usesOf(size_t record) const {
+  return ::range(record_uses.data() + record_uses_begin[record],
+                 record_uses.data() + record_uses_begin[record + 1]);
+}
+
+SsaForm::value_range SsaForm::operandsOf(size_t phi) const {
+  return ::range(phi_operands.data() + phi_operands_begin[phi],
+                 phi_operands.data() + phi_operands_begin[phi + 1]);
+}
+
+std::pair<uint32_t, uint32_t> SsaForm::phisOf(uint32_t block) const {
+  return {block_phis_begin[block], block_phis_begin[block + 1]};
+}
+// ~~~~~ Accessors
+}  // namespace llvm
@@ -0,0 +1,68 @@
+//
+// Created by miro on 10/18/26.
+//
+
+#include <gtest/gtest.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <befa/assembly/analysis.hpp>
+
+namespace {
+
+befa::Analysis previous() {
+  return befa::Analysis{{
+      {"main",    0x400500, 0x40, 1},
+      {"helper",  0x400540, 0x20, 2},
+      {"removed", 0x400560, 0x10, 3},
+  }, nullptr};
+}
+
+befa::Analysis current() {
+  return befa::Analysis{{
+      {"added",   0x400500, 0x10, 4},
+      {"main",    0x400510, 0x40, 1},
+      {"helper",  0x400550, 0x24, 5},
+  }, nullptr};
+}
+
+TEST(AnalysisTest, DiffMatchesByNameAndHash) {
+  befa::AnalysisDiff diff(previous(), current());
+
+  ASSERT_EQ(1u, diff.unchanged.size());
+  EXPECT_EQ("main", diff.unchanged[0].name);
+  EXPECT_EQ(0x400510u, diff.unchanged[0].address);
+  ASSERT_EQ(1u, diff.changed.size());
+  EXPECT_EQ("helper", diff.changed[0].name);
+  ASSERT_EQ(1u, diff.added.size());
+  EXPECT_EQ("added", diff.added[0].name);
+  ASSERT_EQ(1u, diff.removed.size());
+  EXPECT_EQ("removed", diff.removed[0].name);
+}
+
+TEST(AnalysisTest, RemapUnchangedOnly) {
+  befa::AnalysisDiff diff(previous(), current());
+
+  EXPECT_EQ(0x400510u, diff.remap(0x400500));
+  EXPECT_EQ(0x40052au, diff.remap(0x40051a));
+  // past the end of main
+  EXPECT_EQ((bfd_vma) -1, diff.remap(0x400540));
+  // helper has changed
+  EXPECT_EQ((bfd_vma) -1, diff.remap(0x400544));
+  EXPECT_EQ((bfd_vma) -1, diff.remap(0x4004ff));
+}
+
+TEST(AnalysisTest, SaveAndLoad) {
+  char path[] = "/tmp/befa-analysis-XXXXXX";
+  int fd = mkstemp(path);
+  ASSERT_GE(fd, 0);
+  ::close(fd);
+
+  previous().save(path);
+  auto loaded = befa::Analysis::load(path, nullptr);
+  EXPECT_EQ(previous().functions, loaded.functions);
+  ::unlink(path);
+
+  EXPECT_THROW(befa::Analysis::load(path, nullptr), std::runtime_error);
+}
+}  // namespace
@@ -0,0 +1,79 @@
+//
+// Created by miro on 10/18/26.
+//
+
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <vector>
+
+#include <befa/utils/arena.hpp>
+
+namespace {
+
+struct Tracked {
+  Tracked(std::vector<int> &log, int id) : log(log), id(id) {}
+  ~Tracked() { log.push_back(id); }
+
+  std::vector<int> &log;
+  int id;
+};
+
+struct Throwing {
+  Throwing() { throw std::runtime_error("ctor"); }
+  ~Throwing() { ADD_FAILURE() << "destroyed object that was never built"; }
+};
+
+struct alignas(64) Aligned {
+  char data[3];
+};
+
+TEST(ArenaTest, DestroysEverythingAtOnce) {
+  std::vector<int> log;
+  {
+    befa::Arena arena;
+    for (int i = 0; i < 3; ++i)
+      arena.create<Tracked>(log, i);
+    EXPECT_TRUE(log.empty());
+  }
+  EXPECT_EQ((std::vector<int>{2, 1, 0}), log);
+}
+
+TEST(ArenaTest, ThrowingConstructor) {
+  befa::Arena arena;
+  EXPECT_THROW(arena.create<Throwing>(), std::runtime_error);
+}
+
+TEST(ArenaTest, Alignment) {
+  befa::Arena arena(100);
+  for (int i = 0; i < 10; ++i) {
+    arena.create<char>('x');
+    EXPECT_EQ(0u, (uintptr_t) arena.create<Aligned>() % alignof(Aligned));
+  }
+}
+
+TEST(ArenaTest, BigObjects) {
+  befa::Arena arena(16);
+  auto *big = (char *) arena.allocate(1000, 1);
+  std::fill(big, big + 1000, 'x');
+  EXPECT_EQ(1000u, arena.size());
+  EXPECT_LE(arena.size(), arena.capacity());
+}
+
+TEST(ArenaTest, HandlesKeepArenaAlive) {
+  std::vector<int> log;
+  std::weak_ptr<befa::Arena> weak;
+  std::shared_ptr<Tracked> handle;
+  {
+    auto arena = std::make_shared<befa::Arena>();
+    weak = arena;
+    handle = arena->handle<Tracked>(log, 1);
+    arena->handle<Tracked>(log, 2);
+  }
+  EXPECT_FALSE(weak.expired());
+  EXPECT_TRUE(log.empty());
+  EXPECT_EQ(1, handle->id);
+  handle.reset();
+  EXPECT_TRUE(weak.expired());
+  EXPECT_EQ((std::vector<int>{2, 1}), log);
+}
+}  // namespace
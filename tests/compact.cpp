@@ -0,0 +1,97 @@
+//
+// Created by miro on 10/18/26.
+//
+
+#include <gtest/gtest.h>
+
+#include <befa.hpp>
+#include <befa/llvm/call.hpp>
+#include <befa/llvm/cmp.hpp>
+#include <befa/llvm/jmp.hpp>
+#include <befa/llvm/compact.hpp>
+
+#include "lift_fixture.hpp"
+
+namespace {
+
+using Instruction = ExecutableFile::inst_t::info::type;
+using SymbolTable = llvm::InstructionMapper::sym_table_t::type;
+
+std::string to_string(const std::shared_ptr<llvm::VisitableBase> &instr) {
+  return map_visitable<llvm::SerializableVisitorL>(
+      instr, [](const llvm::Serializable *i) { return i->toString(); }
+  );
+}
+
+/**
+ * Factory without records of its own
+ */
+struct NopFactory
+    : public llvm::LLVMFactory {
+  void operator()(
+      a_ir_t::c_info::ref assembly,
+      sym_table_t::ptr::shared,
+      ir_t::rx::shared_subs subscriber
+  ) const override {
+    subscriber.on_next(std::make_shared<llvm::UnaryInstruction>(
+        a_ir_t::vector::value{assembly},
+        std::make_shared<symbol_table::Symbol>("nothing"), "NOP",
+        std::make_shared<symbol_table::Symbol>("nothing")
+    ));
+  }
+
+  bool handles(befa::Mnemonic mnemonic) const override {
+    return mnemonic == befa::Mnemonic::_nop;
+  }
+};
+
+TEST(CompactTest, ViewsMatchInstructions) {
+  auto function = assembly({
+      "test   eax, ebx", "jne    0x0", "cmp    eax, ebx", "jbe    0x0",
+      "cmp    eax, ebx", "ja     0x0", "nop", "mov    eax, ebx"
+  });
+  auto register_all = [](llvm::InstructionMapper &mapper) {
+    mapper.register_factories(
+        std::make_shared<llvm::CompareFactory>(),
+        std::make_shared<llvm::JumpFactory>(),
+        std::make_shared<NopFactory>()
+    );
+  };
+
+  // instructions as objects
+  llvm::InstructionMapper mapper(registers_table());
+  register_all(mapper);
+  std::vector<std::string> expected;
+  mapper.observable().subscribe([&expected](
+      std::shared_ptr<llvm::VisitableBase> instr
+  ) { expected.push_back(to_string(instr)); });
+  rxcpp::subjects::subject<Instruction> i_subj;
+  mapper.reduce_instr(i_subj.get_observable())
+      .subscribe([](std::shared_ptr<SymbolTable>) {});
+  for (auto &i : function)
+    i_subj.get_subscriber().on_next(i);
+  i_subj.get_subscriber().on_completed();
+
+  // the same as records
+  llvm::InstructionMapper compact_mapper(registers_table());
+  register_all(compact_mapper);
+  auto compact = compact_mapper.lift_compact(function);
+  ASSERT_EQ(expected.size(), compact->size());
+  for (size_t i = 0; i < compact->size(); ++i)
+    EXPECT_EQ(expected[i], to_string(compact->view(i))) << i;
+
+  using CompactFunction = llvm::CompactFunction;
+  EXPECT_EQ(20u, sizeof(CompactFunction::Record));
+  EXPECT_EQ(CompactFunction::OPAQUE, compact->record(compact->size() - 1).kind);
+  EXPECT_EQ(CompactFunction::COMPARE, compact->record(2).kind);
+  EXPECT_EQ(0x400000u, compact->getAssembly(compact->record(0)).getAddress());
+  // records of one assembly instruction share it
+  EXPECT_EQ(compact->record(0).assembly, compact->record(3).assembly);
+  // registers are stored once
+  auto zf = symbol_table::registers.at("zf");
+  size_t zf_values = 0;
+  for (size_t id = 0; id < compact->valueCount(); ++id)
+    zf_values += compact->value((CompactFunction::value_id) id).get() == zf;
+  EXPECT_EQ(1u, zf_values);
+}
+}  // namespace
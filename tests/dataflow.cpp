@@ -0,0 +1,136 @@
+//
+// Created by miro on 10/18/26.
+//
+
+#include <gtest/gtest.h>
+
+#include <befa.hpp>
+#include <befa/llvm/dataflow.hpp>
+
+#include "lift_fixture.hpp"
+
+namespace {
+
+using Instruction = ExecutableFile::inst_t::info::type;
+using befa::BitVector;
+
+BitVector bits(std::vector<size_t> set, size_t size = 4) {
+  BitVector vector(size);
+  for (auto bit : set)
+    vector.set(bit);
+  return vector;
+}
+
+/**
+ * B0 -> B1, B2 -> B3
+ */
+std::vector<Instruction> diamond() {
+  return assembly({
+      "cmp    eax, ebx",         // B0
+      "jne    0x400004 <f+4>",
+      "nop",                     // B1
+      "jmp    0x400005 <f+5>",
+      "nop",                     // B2
+      "ret",                     // B3
+  });
+}
+
+TEST(DataflowTest, BitVector) {
+  BitVector full(130, true);
+  EXPECT_EQ(130u, full.count());
+  EXPECT_TRUE(full.test(129));
+
+  auto some = bits({1, 64, 129}, 130);
+  EXPECT_EQ(3u, some.count());
+  full.subtract(some);
+  EXPECT_EQ(127u, full.count());
+  EXPECT_FALSE(full.test(64));
+
+  BitVector value(130);
+  EXPECT_FALSE(value.any());
+  EXPECT_TRUE(value.transfer(bits({0}, 130), some, bits({1}, 130)));
+  EXPECT_EQ(bits({0, 64, 129}, 130), value);
+  EXPECT_FALSE(value.transfer(bits({0}, 130), some, bits({1}, 130)));
+
+  value &= some;
+  EXPECT_EQ(bits({64, 129}, 130), value);
+  value |= bits({2}, 130);
+  EXPECT_EQ(3u, value.count());
+}
+
+TEST(DataflowTest, Forward) {
+  auto function = diamond();
+  llvm::FlowGraph graph(function);
+  ASSERT_EQ(4u, graph.blocks.size());
+
+  llvm::GenKillProblem<llvm::UnionMeet, llvm::FORWARD> may(4, 4);
+  may.gen[1] = bits({0});
+  may.gen[2] = bits({1});
+  may.kill[2] = bits({0});
+  may.outside = bits({3});
+  auto reaching = llvm::solve_dataflow(graph, may);
+  EXPECT_EQ(bits({3}), reaching.in[0]);
+  EXPECT_EQ(bits({0, 3}), reaching.out[1]);
+  EXPECT_EQ(bits({0, 1, 3}), reaching.in[3]);
+
+  llvm::GenKillProblem<llvm::IntersectionMeet, llvm::FORWARD> must(4, 4);
+  must.gen = may.gen;
+  must.kill = may.kill;
+  must.outside = may.outside;
+  auto available = llvm::solve_dataflow(graph, must);
+  EXPECT_EQ(bits({3}), available.in[3]);
+  EXPECT_EQ(bits({1, 3}), available.out[2]);
+}
+
+TEST(DataflowTest, Backward) {
+  auto function = diamond();
+  llvm::FlowGraph graph(function);
+
+  llvm::GenKillProblem<llvm::UnionMeet, llvm::BACKWARD> live(4, 4);
+  live.gen[3] = bits({2});
+  live.kill[1] = bits({2});
+  live.gen[0] = bits({1});
+  auto solution = llvm::solve_dataflow(graph, live);
+  EXPECT_EQ(bits({}), solution.out[3]);
+  EXPECT_EQ(bits({2}), solution.in[3]);
+  EXPECT_EQ(bits({}), solution.in[1]);
+  EXPECT_EQ(bits({2}), solution.out[0]);
+  EXPECT_EQ(bits({1, 2}), solution.in[0]);
+}
+
+TEST(DataflowTest, Loop) {
+  auto function = assembly({
+      "nop",                     // B0 loops to itself
+      "jne    0x400000 <f>",
+      "ret",                     // B1
+  });
+  llvm::FlowGraph graph(function);
+  ASSERT_EQ(2u, graph.blocks.size());
+
+  llvm::GenKillProblem<llvm::UnionMeet, llvm::FORWARD> may(2, 4);
+  may.gen[0] = bits({0});
+  may.outside = bits({3});
+  auto solution = llvm::solve_dataflow(graph, may);
+  EXPECT_EQ(bits({0, 3}), solution.in[0]);
+  EXPECT_EQ(bits({0, 3}), solution.in[1]);
+}
+
+TEST(DataflowTest, RegisterBits) {
+  using symbol_table::RegisterId;
+  static_assert(
+      llvm::register_bit(RegisterId::_eax)
+      == llvm::register_bit(RegisterId::_rax),
+      "parts of register share bit"
+  );
+  EXPECT_EQ(llvm::register_bit(RegisterId::_rax),
+            llvm::register_bit(RegisterId::_ah));
+  EXPECT_EQ(llvm::register_bit(RegisterId::_r9),
+            llvm::register_bit(RegisterId::_r9d));
+  EXPECT_NE(llvm::register_bit(RegisterId::_rax),
+            llvm::register_bit(RegisterId::_rbx));
+  EXPECT_NE(llvm::register_bit(RegisterId::_cf),
+            llvm::register_bit(RegisterId::_zf));
+  for (size_t id = 0; id < symbol_table::register_count; ++id)
+    EXPECT_GT(llvm::register_bits, llvm::register_bit((RegisterId) id));
+}
+}  // namespace
@@ -10,6 +10,7 @@
 
 #include <befa/utils/visitor.hpp>
 #include <befa/assembly/instruction_parser.hpp>
+#include <befa/assembly/registers.hpp>
 #include <befa/assembly/instruction.hpp>
 #include <befa.hpp>
 #include <befa/llvm/instruction.hpp>
@@ -108,6 +109,152 @@ TEST(DecoderTest, TestLEA) {
       .subscribe(create_check_fn("4009b0"));
 }
 
+TEST(DecoderTest, ArenaNodes) {
+  InstructionTemplate simple_instr("mov DWORD PTR [eax*0x8+0x666],ebx");
+  std::weak_ptr<befa::Arena> weak;
+  std::vector<std::shared_ptr<symbol_table::VisitableBase>> args;
+  {
+    auto arena = std::make_shared<befa::Arena>();
+    weak = arena;
+    simple_instr.getArgs({}, arena).subscribe([&args](auto arg) {
+      args.push_back(arg);
+    });
+    EXPECT_LT(0u, arena->size());
+  }
+  ASSERT_EQ(2u, args.size());
+  invoke_accept(args[0], create_test_visitor(
+      "((DWORD)*((((DWORD)_eax)) * ((0x8) + (0x666))))"
+  ));
+  invoke_accept(args[1], create_test_visitor("((DWORD)_ebx)"));
+  EXPECT_FALSE(weak.expired());
+  args.clear();
+  EXPECT_TRUE(weak.expired());
+}
+
+TEST(DecoderTest, SharedExpressions) {
+  auto pool = std::make_shared<symbol_table::ExpressionPool>();
+  auto parse = [&pool](const std::string &decoded) {
+    std::vector<std::shared_ptr<symbol_table::VisitableBase>> args;
+    InstructionTemplate(decoded).getArgs({}, pool).subscribe([&args](
+        auto arg
+    ) { args.push_back(arg); });
+    return args;
+  };
+  auto mov = parse("mov    QWORD PTR [rbp-0x8],0x0");
+  auto add = parse("add    QWORD PTR [rbp-0x8],0x0");
+  auto sub = parse("sub    DWORD PTR [rbp-0x8],0x8");
+  ASSERT_EQ(2u, mov.size());
+  ASSERT_EQ(2u, add.size());
+  ASSERT_EQ(2u, sub.size());
+  EXPECT_EQ(mov[0], add[0]);
+  EXPECT_EQ(mov[1], add[1]);
+  // different size, same address
+  EXPECT_NE(mov[0], sub[0]);
+  auto address = [](const std::shared_ptr<symbol_table::VisitableBase> &ptr) {
+    auto deref = std::dynamic_pointer_cast<symbol_table::Temporary>(ptr);
+    return deref ? deref->getRight().get() : nullptr;
+  };
+  EXPECT_NE(nullptr, address(mov[0]));
+  EXPECT_EQ(address(mov[0]), address(sub[0]));
+  // rbp-0x8, 0x8, two dereferences and immidiates 0 and 8 (without 0x)
+  EXPECT_EQ(6u, pool->size());
+}
+
+TEST(DecoderTest, NumericImmidiate) {
+  using symbol_table::Immidiate;
+  struct {
+    std::string text;
+    bool numeric;
+    uint64_t number;
+    int64_t signed_number;
+    uint8_t width;
+  } cases[] = {
+      {"0x8", true, 0x8, 8, 8},
+      {"8", true, 0x8, 8, 8},
+      {"ff", true, 0xff, -1, 8},
+      {"0xFF", true, 0xff, -1, 8},
+      {"00401000", true, 0x401000, 0x401000, 32},
+      {"0xffffffffffffff80", true, (uint64_t) -128, -128, 64},
+      {"0xfF", false, 0, 0, 64},
+      {"0x123456789abcdef01", false, 0, 0, 64},
+      {"TempResult", false, 0, 0, 64},
+  };
+  for (auto &test : cases) {
+    Immidiate immidiate(test.text);
+    EXPECT_EQ(test.numeric, immidiate.isNumeric()) << test.text;
+    // name keeps format
+    EXPECT_EQ(test.text, immidiate.getName());
+    EXPECT_EQ(test.text, immidiate.getValue());
+    if (!test.numeric)
+      continue;
+    EXPECT_EQ(test.number, immidiate.getUnsigned()) << test.text;
+    EXPECT_EQ(test.signed_number, immidiate.getSigned()) << test.text;
+    EXPECT_EQ(test.width, immidiate.getWidth()) << test.text;
+  }
+
+  Immidiate built(0x1f, 8);
+  EXPECT_EQ("0x1f", built.getName());
+  EXPECT_EQ(31, built.getSigned());
+  EXPECT_EQ("0x0", Immidiate(0, 64).getName());
+  EXPECT_EQ(-1, Immidiate(0xffff, 16).getSigned());
+
+  InstructionTemplate add("add    rsp,0xffffffffffffff80");
+  std::vector<std::shared_ptr<symbol_table::VisitableBase>> args;
+  add.getArgs().subscribe([&args](auto arg) { args.push_back(arg); });
+  ASSERT_EQ(2u, args.size());
+  auto immidiate = std::dynamic_pointer_cast<Immidiate>(args[1]);
+  ASSERT_NE(nullptr, immidiate);
+  EXPECT_EQ(-128, immidiate->getSigned());
+}
+
+struct CountingSymbol
+    : public symbol_table::Symbol {
+  CountingSymbol() : Symbol(lazy_name_t()) {}
+
+  std::string renderName() const override {
+    ++rendered;
+    return "x";
+  }
+
+  mutable int rendered = 0;
+};
+
+TEST(DecoderTest, LazyTemporaryName) {
+  using namespace symbol_table;
+  auto x = std::make_shared<CountingSymbol>();
+  auto sum = std::make_shared<Temporary>(x, "+", x);
+  auto deref = std::make_shared<SizedTemporary<symbol_table::types::QWORD>>("*", sum);
+  auto cast = std::make_shared<SizedTemporary<symbol_table::types::BYTE>>(deref);
+  EXPECT_EQ(0, x->rendered);
+
+  EXPECT_EQ("((BYTE)((QWORD)*((x) + (x))))", cast->getName());
+  EXPECT_EQ("(x) + (x)", sum->getName());
+  // names are cached
+  EXPECT_EQ(1, x->rendered);
+}
+
+TEST(DecoderTest, CachedPieces) {
+  auto instruction = std::make_unique<InstructionTemplate>(
+      "mov    DWORD PTR [rbp-0x14],edi"
+  );
+  EXPECT_EQ("mov", instruction->getMnemonic());
+  EXPECT_EQ("mov", instruction->getName());
+
+  // pieces point into decoded text of the copy
+  InstructionTemplate copy(*instruction);
+  instruction.reset();
+  std::vector<std::string> pieces;
+  copy.parse().subscribe([&pieces](const std::string &piece) {
+    pieces.push_back(piece);
+  });
+  EXPECT_EQ(
+      (std::vector<std::string>{"mov", "DWORD PTR [rbp-0x14]", "edi"}),
+      pieces
+  );
+  copy.getArgs().element_at(0)
+      .subscribe(create_check_fn("((DWORD)*((((QWORD)_rbp)) - (0x14)))"));
+}
+
 using Symbol = ExecutableFile::sym_t::info::type;
 
 struct DummySymbol
@@ -137,4 +284,103 @@ TEST(DecoderTest, TestFunctionFeed) {
   args.first()
       .subscribe(create_check_fn("@number_of_the_beast"));
 }
+
+TEST(DecoderTest, RegisterTable) {
+  using symbol_table::RegisterId;
+  static_assert(
+      symbol_table::find_register("eax") == RegisterId::_eax,
+      "register lookup should work at compile time"
+  );
+
+  ASSERT_EQ(symbol_table::register_count, symbol_table::registers.size());
+  for (size_t id = 0; id < symbol_table::register_count; ++id) {
+    auto &info = symbol_table::register_info[id];
+    EXPECT_EQ((RegisterId) id, symbol_table::find_register(info.name));
+    EXPECT_EQ(
+        symbol_table::registers.at(std::string(info.name)),
+        symbol_table::get_register((RegisterId) id)
+    );
+    EXPECT_EQ((RegisterId) id, symbol_table::register_id(
+        symbol_table::get_register((RegisterId) id)
+    ));
+  }
+  EXPECT_EQ(RegisterId::count, symbol_table::register_id(nullptr));
+  for (auto unknown : {"", "RAX", "eaxx", "ea", "rax ", "xmm8", "rflags"})
+    EXPECT_EQ(RegisterId::count, symbol_table::find_register(unknown));
+
+  auto &ah = symbol_table::register_info[(size_t) RegisterId::_ah];
+  EXPECT_EQ(8u, ah.width);
+  EXPECT_EQ(RegisterId::_rax, ah.parent);
+  EXPECT_EQ(8u, ah.offset);
+  auto &r9d = symbol_table::register_info[(size_t) RegisterId::_r9d];
+  EXPECT_EQ(32u, r9d.width);
+  EXPECT_EQ(RegisterId::_r9, r9d.parent);
+  EXPECT_EQ(1u, symbol_table::register_info[(size_t) RegisterId::_zf].width);
+}
+
+TEST(DecoderTest, MnemonicTable) {
+  using befa::Mnemonic;
+  using befa::Condition;
+  static_assert(
+      befa::find_mnemonic("and") == Mnemonic::_and,
+      "mnemonic lookup should work at compile time"
+  );
+
+  for (size_t id = 0; id < befa::mnemonic_count; ++id)
+    EXPECT_EQ(
+        (Mnemonic) id, befa::find_mnemonic(befa::mnemonic_info[id].name)
+    );
+  for (auto unknown : {"", "MOV", "movv", "j", "rax"})
+    EXPECT_EQ(Mnemonic::unknown, befa::find_mnemonic(unknown));
+
+  EXPECT_TRUE(befa::is_jcc(Mnemonic::_jnbe));
+  EXPECT_FALSE(befa::is_jcc(Mnemonic::_jmp));
+  EXPECT_TRUE(befa::is_jmp(Mnemonic::_jmp));
+  EXPECT_TRUE(befa::is_call(Mnemonic::_call));
+  EXPECT_TRUE(befa::is_ret(Mnemonic::_ret));
+  EXPECT_FALSE(befa::is_call(Mnemonic::unknown));
+  EXPECT_EQ(Condition::e, befa::condition(Mnemonic::_jz));
+  EXPECT_EQ(Condition::e, befa::condition(Mnemonic::_je));
+  EXPECT_EQ(Condition::a, befa::condition(Mnemonic::_jnbe));
+  EXPECT_EQ(Condition::l, befa::condition(Mnemonic::_setl));
+  EXPECT_EQ(Condition::none, befa::condition(Mnemonic::_mov));
+
+  EXPECT_EQ(Mnemonic::_jnbe, InstructionTemplate("jnbe   400500").getMnemonicId());
+  EXPECT_EQ(Mnemonic::_mov, InstructionTemplate("mov    eax,ebx").getMnemonicId());
+  EXPECT_EQ(Mnemonic::unknown, InstructionTemplate("(bad)").getMnemonicId());
+}
+
+TEST(DecoderTest, PrefixedMnemonic) {
+  using befa::Mnemonic;
+  std::vector<std::pair<std::string, Mnemonic>> prefixed{
+      {"bnd jmp 0x400500 <main+16>",             Mnemonic::_jmp},
+      {"bnd jne 0x400500 <main+16>",             Mnemonic::_jne},
+      {"notrack jmp rax",                        Mnemonic::_jmp},
+      {"bnd ret",                                Mnemonic::_ret},
+      {"repz ret",                               Mnemonic::_ret},
+      {"rep stos QWORD PTR es:[rdi],rax",        Mnemonic::_stos},
+      {"repnz scas al,BYTE PTR es:[rdi]",        Mnemonic::_scas},
+      {"lock cmpxchg DWORD PTR [rdx],ecx",       Mnemonic::_cmpxchg},
+      {"data16 cs nop WORD PTR [rax+rax*1+0x0]", Mnemonic::_nop},
+      {"rex.W jmp rax",                          Mnemonic::_jmp},
+  };
+  for (auto &instruction : prefixed)
+    EXPECT_EQ(
+        instruction.second, InstructionTemplate(instruction.first).getMnemonicId()
+    ) << instruction.first;
+
+  InstructionTemplate jump("notrack jmp rax");
+  EXPECT_EQ("jmp", jump.getMnemonic());
+  std::vector<std::string> pieces;
+  jump.parse().subscribe([&pieces](const std::string &piece) {
+    pieces.push_back(piece);
+  });
+  EXPECT_EQ((std::vector<std::string>{"jmp", "rax"}), pieces);
+
+  // prefix without instruction stays as it is
+  EXPECT_EQ("lock", InstructionTemplate("lock").getMnemonic());
+  EXPECT_EQ(Mnemonic::unknown, InstructionTemplate("lock").getMnemonicId());
+  EXPECT_EQ("jmp    rax", befa::skip_prefixes("bnd   jmp    rax"));
+  EXPECT_EQ("ret", befa::skip_prefixes("ret"));
+}
 }
@@ -22,6 +22,8 @@
 
 #include <befa.hpp>
 
+#include "lift_fixture.hpp"
+
 namespace {
 struct dummy_parent {};
 
@@ -248,5 +250,219 @@ TEST(DecompilerTest, JmpTest) {
       }
   );
 }
-}  // namespace
 
+TEST(DecompilerTest, TwoCallsTest) {
+  test_asm_to_llvm(
+      // asm instructions
+      {"call    0x400800", "call    0x400900"},
+      // symbol table
+      concat(
+          {
+              {"printf",
+               std::make_shared<symbol_table::Function>(
+                   std::make_shared<DummySymbol>("printf", 0x400800)
+               )
+              },
+              {"puts",
+               std::make_shared<symbol_table::Function>(
+                   std::make_shared<DummySymbol>("puts", 0x400900)
+               )
+              }
+          },
+          registers_map()
+      ),
+      // result of the call is shared
+      {
+          "ResultOfTheCall = call @printf()",
+          "ResultOfTheCall = call @puts()"
+      }
+  );
+}
+
+/**
+ * Lifts instructions of functions, returns created instructions as text
+ */
+std::vector<std::string> lift_functions(
+    const std::vector<std::vector<std::string>> &functions,
+    size_t workers
+) {
+  using BasicBlock = ExecutableFile::bb_t::info::type;
+  llvm::InstructionMapper mapper(registers_table());
+  mapper.register_factories(
+      std::make_shared<llvm::CallFactory>(),
+      std::make_shared<llvm::CompareFactory>(),
+      std::make_shared<llvm::JumpFactory>()
+  );
+  std::vector<std::string> lifted;
+  mapper.observable().subscribe([&lifted](
+      std::shared_ptr<llvm::VisitableBase> instr
+  ) {
+    lifted.push_back(map_visitable<llvm::SerializableVisitorL>(
+        instr, [](const llvm::Serializable *i) { return i->toString(); }
+    ));
+  });
+
+  rxcpp::subjects::subject<Instruction> i_subj;
+  auto reduced = workers
+                 ? mapper.reduce_functions(i_subj.get_observable(), workers)
+                 : mapper.reduce_instr(i_subj.get_observable());
+  reduced.subscribe([](std::shared_ptr<SymbolTable>) {});
+  auto subscriber = i_subj.get_subscriber();
+  // parents has to outlive lifting
+  std::vector<std::shared_ptr<Symbol>> symbols;
+  std::vector<std::shared_ptr<BasicBlock>> blocks;
+  bfd_vma address = 0x400000;
+  for (auto &function : functions) {
+    symbols.push_back(std::make_shared<DummySymbol>("f", address));
+    blocks.push_back(std::make_shared<BasicBlock>(address, symbols.back()));
+    for (auto &decoded : function)
+      subscriber.on_next(Instruction({}, blocks.back(), decoded, address++));
+  }
+  subscriber.on_completed();
+  return lifted;
+}
+
+TEST(DecompilerTest, ParallelFunctions) {
+  std::vector<std::vector<std::string>> functions;
+  for (size_t i = 0; i < 12; ++i)
+    functions.push_back(i % 2
+                        ? std::vector<std::string>{"test   eax, ebx", "jne    0x0"}
+                        : std::vector<std::string>{"cmp    eax, ebx", "jbe    0x0"});
+  auto sequential = lift_functions(functions, 0);
+  ASSERT_FALSE(sequential.empty());
+  // the same instructions in the same order for any number of workers
+  EXPECT_EQ(sequential, lift_functions(functions, 1));
+  EXPECT_EQ(sequential, lift_functions(functions, 4));
+  EXPECT_EQ(sequential, lift_functions(functions, 64));
+}
+
+/**
+ * Exposes number of addresses stored in table itself
+ */
+struct LocalSymTable
+    : public llvm::SymTable {
+  using llvm::SymTable::SymTable;
+
+  size_t storedAddresses() const { return addresses.size(); }
+};
+
+TEST(DecompilerTest, LayeredSymTable) {
+  auto global = registers_table();
+  auto printf = global->add_symbol<symbol_table::Symbol>("printf", 0x400800);
+  auto local = std::make_shared<LocalSymTable>(
+      std::shared_ptr<const llvm::SymTable>(global)
+  );
+
+  // lookups fall through into global
+  EXPECT_EQ(printf, local->find_symbol("printf"));
+  EXPECT_EQ(printf, local->find_symbol(0x400800));
+  EXPECT_EQ(printf, local->address_map().find(0x400800));
+
+  auto added = local->add_symbol<symbol_table::Symbol>("puts", 0x400900);
+  EXPECT_EQ(added, local->find_symbol("puts"));
+  EXPECT_EQ(added, local->address_map().find(0x400900));
+  EXPECT_EQ(printf, local->address_map().find(0x400800));
+  // symbol of global is not replaced on its address
+  local->add_symbol<symbol_table::Symbol>("printf_alias", 0x400800);
+  EXPECT_EQ(printf, local->address_map().find(0x400800));
+  // global is not copied into local
+  EXPECT_EQ(1u, local->storedAddresses());
+  EXPECT_EQ(global->to_map().size() + 1, local->to_map().size());
+  // global stays untouched until merge
+  EXPECT_EQ(nullptr, global->find_symbol("puts"));
+  EXPECT_EQ(0u, global->address_map().count(0x400900));
+
+  global->merge(*local);
+  EXPECT_EQ(added, global->find_symbol("puts"));
+  EXPECT_EQ(added, global->find_symbol(0x400900));
+}
+
+/**
+ * Counts instructions it has received
+ */
+struct CountingFactory
+    : public llvm::LLVMFactory {
+  explicit CountingFactory(befa::Mnemonic only) : only(only) {}
+
+  void operator()(
+      a_ir_t::c_info::ref,
+      sym_table_t::ptr::shared,
+      ir_t::rx::shared_subs
+  ) const override {
+    ++count;
+  }
+
+  bool handles(befa::Mnemonic mnemonic) const override {
+    return only == befa::Mnemonic::unknown || mnemonic == only;
+  }
+
+  befa::Mnemonic only;
+  mutable size_t count = 0;
+};
+
+TEST(DecompilerTest, FactoryDispatch) {
+  auto symbol_table = std::make_shared<llvm::SymTable>(
+      std::make_shared<SymbolMap>()
+  );
+  auto mapper = std::make_shared<llvm::InstructionMapper>(symbol_table);
+  // unknown stands for "every mnemonic" here
+  auto all = std::make_shared<CountingFactory>(befa::Mnemonic::unknown);
+  auto calls = std::make_shared<CountingFactory>(befa::Mnemonic::_call);
+  auto removed = std::make_shared<CountingFactory>(befa::Mnemonic::_call);
+  mapper->register_factories(all, calls, removed);
+  mapper->remove_factory(removed.get());
+
+  rxcpp::subjects::subject<Instruction> i_subj;
+  auto subscription = mapper->reduce_instr(i_subj.get_observable())
+      .subscribe([](std::shared_ptr<SymbolTable>) {});
+  auto subscriber = i_subj.get_subscriber();
+  for (auto decoded : {"call    0x400800", "mov    eax,0x1",
+                       "call    0x400900", "vfoo   eax"})
+    subscriber.on_next(InstructionTemplate(decoded));
+  subscriber.on_completed();
+
+  EXPECT_EQ(4u, all->count);
+  EXPECT_EQ(2u, calls->count);
+  EXPECT_EQ(0u, removed->count);
+
+  EXPECT_TRUE(llvm::CallFactory().handles(befa::Mnemonic::_call));
+  EXPECT_FALSE(llvm::CallFactory().handles(befa::Mnemonic::_mov));
+  EXPECT_TRUE(llvm::CompareFactory().handles(befa::Mnemonic::_test));
+  EXPECT_TRUE(llvm::JumpFactory().handles(befa::Mnemonic::_jne));
+  EXPECT_FALSE(llvm::JumpFactory().handles(befa::Mnemonic::_jmp));
+}
+
+TEST(DecompilerTest, SymTableLookup) {
+  auto symbol_map = std::make_shared<SymbolMap>(registers_map());
+  auto printf = std::make_shared<symbol_table::Function>(
+      std::make_shared<DummySymbol>("printf", 0x400800)
+  );
+  symbol_map->emplace("printf", printf);
+  llvm::SymTable table(symbol_map);
+
+  auto zf = symbol_table::registers.at("zf");
+  EXPECT_EQ(zf, table.find_symbol("zf").get());
+  EXPECT_EQ(printf, table.find_symbol("printf"));
+  EXPECT_EQ(printf, table.find_symbol(0x400800));
+  // names have to match exactly
+  EXPECT_EQ(nullptr, table.find_symbol("_zf"));
+  EXPECT_EQ(nullptr, table.find_symbol(0x400801));
+  EXPECT_EQ(zf, table.find_symbol_containing("_zf").get());
+
+  auto added = table.add_symbol<symbol_table::Symbol>("TempResult", 0x1234);
+  EXPECT_EQ(added, table.find_symbol("TempResult"));
+  EXPECT_EQ(added, table.find_symbol(0x1234));
+  EXPECT_EQ(1u, symbol_map->count("TempResult"));
+  EXPECT_EQ(added, table.get_or_create<symbol_table::Symbol>(
+      "TempResult", "TempResult", 0x1234
+  ));
+
+  // address view is maintained by add_symbol, the same as to_map
+  auto addresses = table.address_map();
+  EXPECT_EQ(added, addresses.find(0x1234));
+  EXPECT_EQ(printf, addresses.find(0x400800));
+  EXPECT_EQ(added, table.to_map().at(0x1234));
+  auto later = table.add_symbol<symbol_table::Symbol>("Later", 0x5678);
+  EXPECT_EQ(later, addresses.find(0x5678));
+}
+}  // namespace
@@ -7,7 +7,12 @@
 #include <algorithm>
 
 #include "../include/befa/utils/algorithms.hpp"
+#include "../include/befa/llvm/call.hpp"
+#include "../include/befa/llvm/cmp.hpp"
+#include "../include/befa/llvm/jmp.hpp"
+#include "../include/befa/llvm/function_cache.hpp"
 #include "fixtures.hpp"
+#include "lift_fixture.hpp"
 
 namespace {
 
@@ -102,5 +107,192 @@ TEST_F(ExecutableFixture, TestInstruction) {
       });
 }
 
-}  // namespace
+TEST_F(ExecutableFixture, PrefetchMatchesSynchronousRead) {
+  auto collect = [](size_t budget) {
+    std::vector<std::pair<bfd_vma, std::string>> result;
+    auto file = ExecutableFile::open(file_name);
+    file.setPrefetchBudget(budget);
+    file.disassembly()
+        .subscribe([&result](ExecutableFile::inst_t::c_info::ref instr) {
+          result.emplace_back(instr.getAddress(), instr.getDecoded());
+        });
+    file.runDisassembler();
+    return result;
+  };
+
+  auto prefetched = collect(befa::SectionPrefetcher::default_budget);
+  EXPECT_FALSE(prefetched.empty());
+  // budget smaller than any section forces worker to wait for every take
+  EXPECT_EQ(prefetched, collect(1));
+  EXPECT_EQ(prefetched, collect(0));
+}
+
+TEST_F(ExecutableFixture, FunctionCacheMatchesDecoder) {
+  auto cache = std::make_shared<llvm::FunctionCache>();
+  auto collect = [](std::shared_ptr<llvm::FunctionCache> cache) {
+    std::vector<std::pair<bfd_vma, std::string>> result;
+    auto file = ExecutableFile::open(file_name);
+    file.setFunctionCache(cache);
+    file.disassembly()
+        .subscribe([&result](ExecutableFile::inst_t::c_info::ref instr) {
+          result.emplace_back(instr.getAddress(), instr.getDecoded());
+        });
+    file.runDisassembler();
+    return result;
+  };
+
+  auto decoded = collect(nullptr);
+  // first run fills the cache, second one is replayed from it
+  EXPECT_EQ(decoded, collect(cache));
+  EXPECT_LT(0u, cache->size());
+  EXPECT_EQ(decoded, collect(cache));
+}
+
+TEST_F(ExecutableFixture, StreamingMatchesBufferedRun) {
+  auto collect = [](size_t budget) {
+    std::vector<std::pair<bfd_vma, std::string>> result;
+    auto file = ExecutableFile::open(file_name);
+    file.setMemoryBudget(budget);
+    file.disassembly()
+        .subscribe([&result](ExecutableFile::inst_t::c_info::ref instr) {
+          // parent is alive while instruction is being processed
+          EXPECT_TRUE((bool) instr.getParent());
+          result.emplace_back(instr.getAddress(), instr.getDecoded());
+        });
+    file.runDisassembler();
+    return result;
+  };
+
+  auto buffered = collect(0);
+  EXPECT_FALSE(buffered.empty());
+  // budget smaller than any section evicts on every section switch
+  EXPECT_EQ(buffered, collect(1));
+}
+
+TEST_F(ExecutableFixture, StreamingStaysInBudget) {
+  size_t largest = 0;
+  for (auto &section : file.getSections())
+    largest = std::max(largest, ptr_lock(section)->getSize(nullptr));
+  ASSERT_LT(0u, largest);
+
+  auto peak = [](size_t budget) {
+    auto file = ExecutableFile::open(file_name);
+    file.setMemoryBudget(budget);
+    file.runDisassembler();
+    return file.getPeakSectionBytes();
+  };
+  // section being decoded has to be held anyway
+  EXPECT_LE(peak(1), largest);
+  // read-ahead shares budget with sections held by disassembler
+  EXPECT_LE(peak(2 * largest), 2 * largest);
+  EXPECT_LE(peak(3 * largest), 3 * largest);
+}
+
+TEST_F(ExecutableFixture, StreamingOutlivesSubscribers) {
+  using Instruction = ExecutableFile::inst_t::info::type;
+  auto cache = std::make_shared<llvm::FunctionCache>();
+  // lifted text and bytes of instructions read after disassembler is done
+  auto lift = [&cache](size_t budget, bool functions) {
+    std::vector<std::string> lifted;
+    std::vector<Instruction> held;
+    auto file = ExecutableFile::open(file_name);
+    file.setMemoryBudget(budget);
+    file.setFunctionCache(cache);
+    llvm::InstructionMapper mapper(registers_table());
+    mapper.register_factories(
+        std::make_shared<llvm::CallFactory>(),
+        std::make_shared<llvm::CompareFactory>(),
+        std::make_shared<llvm::JumpFactory>()
+    );
+    mapper.set_function_cache(cache);
+    // instructions wait for the end of their function
+    mapper.set_flag_liveness(true);
+    mapper.observable().subscribe([&lifted](
+        std::shared_ptr<llvm::VisitableBase> instr
+    ) {
+      lifted.push_back(map_visitable<llvm::SerializableVisitorL>(
+          instr, [](const llvm::Serializable *i) { return i->toString(); }
+      ));
+    });
+    auto reduced = functions
+                   ? mapper.reduce_functions(file.disassembly(), 2)
+                   : mapper.reduce_instr(file.disassembly());
+    reduced.subscribe([](llvm::InstructionMapper::sym_table_t::ptr::shared) {});
+    file.disassembly().subscribe([&held](const Instruction &instr) {
+      held.push_back(instr);
+    });
+    file.runDisassembler();
+
+    std::vector<std::vector<uint8_t>> bytes;
+    for (auto &instr : held) {
+      EXPECT_TRUE(instr.hasParent());
+      auto &view = instr.getBytes();
+      bytes.emplace_back(view.get(), view.get() + view.size());
+    }
+    return std::make_pair(lifted, bytes);
+  };
 
+  // the first run fills the cache, streamed ones replay from it
+  auto buffered = lift(0, false);
+  EXPECT_FALSE(buffered.first.empty());
+  EXPECT_EQ(buffered, lift(1, false));
+  auto functions = lift(0, true);
+  EXPECT_EQ(functions, lift(1, true));
+  EXPECT_EQ(buffered.second, functions.second);
+}
+
+TEST_F(ExecutableFixture, VisitorEventsAreNested) {
+  using section_type = ExecutableFile::sec_t::type;
+  using symbol_type = ExecutableFile::sym_t::type;
+  using basic_block_type = ExecutableFile::bb_t::type;
+  using instr_type = ExecutableFile::inst_t::type;
+
+  struct Recorder : public ExecutableFile::visitor_t {
+    void sectionBegin(const section_type &) override { depth(0, 1); }
+    void sectionEnd(const section_type &) override { depth(1, 0); }
+    void symbolBegin(const symbol_type &) override { depth(1, 2); }
+    void symbolEnd(const symbol_type &) override { depth(2, 1); }
+    void blockBegin(const basic_block_type &) override { depth(2, 3); }
+    void blockEnd(const basic_block_type &) override { depth(3, 2); }
+    void instruction(const instr_type &instr) override {
+      EXPECT_EQ(3, level);
+      instructions.push_back(instr.getAddress());
+    }
+
+    void depth(int from, int to) {
+      EXPECT_EQ(from, level);
+      level = to;
+    }
+
+    int level = 0;
+    std::vector<bfd_vma> instructions;
+  } recorder;
+
+  std::vector<bfd_vma> streamed;
+  file.disassembly()
+      .subscribe([&streamed](ExecutableFile::inst_t::c_info::ref instr) {
+        streamed.push_back(instr.getAddress());
+      });
+  file.runDisassembler(recorder);
+  EXPECT_EQ(0, recorder.level);
+  EXPECT_FALSE(streamed.empty());
+  EXPECT_EQ(streamed, recorder.instructions);
+}
+
+TEST_F(ExecutableFixture, IncrementalRunOfSameFile) {
+  file.setFunctionCache(std::make_shared<llvm::FunctionCache>());
+  file.runDisassembler();
+  auto analysis = file.getAnalysis();
+  EXPECT_FALSE(analysis.functions.empty());
+
+  auto rebuilt = ExecutableFile::open(file_name);
+  auto diff = rebuilt.runIncremental(analysis);
+  EXPECT_EQ(analysis.functions.size(), diff.unchanged.size());
+  EXPECT_TRUE(diff.changed.empty());
+  EXPECT_TRUE(diff.added.empty());
+  EXPECT_TRUE(diff.removed.empty());
+  for (auto &function : analysis.functions)
+    EXPECT_EQ(function.address, diff.remap(function.address));
+}
+
+}  // namespace
@@ -0,0 +1,190 @@
+//
+// Created by miro on 10/18/26.
+//
+
+#include <gtest/gtest.h>
+
+#include <befa.hpp>
+#include <befa/llvm/call.hpp>
+#include <befa/llvm/cmp.hpp>
+#include <befa/llvm/jmp.hpp>
+#include <befa/llvm/compact.hpp>
+#include <befa/llvm/flags.hpp>
+
+#include "lift_fixture.hpp"
+
+namespace {
+
+using Instruction = ExecutableFile::inst_t::info::type;
+using SymbolMap = ExecutableFile::map_t::info::type;
+using SymbolTable = llvm::InstructionMapper::sym_table_t::type;
+
+std::vector<std::string> lift(
+    const std::vector<Instruction> &function,
+    bool flag_liveness,
+    bool branch_fusion = false
+) {
+  llvm::InstructionMapper mapper(registers_table());
+  mapper.register_factories(
+      std::make_shared<llvm::CompareFactory>(),
+      std::make_shared<llvm::JumpFactory>()
+  );
+  mapper.set_flag_liveness(flag_liveness);
+  mapper.set_branch_fusion(branch_fusion);
+
+  std::vector<std::string> lifted;
+  mapper.observable().subscribe([&lifted](
+      std::shared_ptr<llvm::VisitableBase> instr
+  ) {
+    lifted.push_back(map_visitable<llvm::SerializableVisitorL>(
+        instr, [](const llvm::Serializable *i) { return i->toString(); }
+    ));
+  });
+  rxcpp::subjects::subject<Instruction> i_subj;
+  mapper.reduce_instr(i_subj.get_observable())
+      .subscribe([](std::shared_ptr<SymbolTable>) {});
+  for (auto &i : function)
+    i_subj.get_subscriber().on_next(i);
+  i_subj.get_subscriber().on_completed();
+
+  // lift_compact has to agree
+  auto compact = mapper.lift_compact(function);
+  EXPECT_EQ(lifted.size(), compact->size());
+  return lifted;
+}
+
+TEST(FlagsTest, FlowGraph) {
+  auto function = assembly({
+      "cmp    eax, ebx",         // 0 block 0
+      "jne    0x400003 <f+3>",   // 1
+      "cmp    eax, ecx",         // 2 block 1
+      "jb     0x400005 <f+5>",   // 3 block 2
+      "jmp    rax",              // 4 block 3
+      "ret",                     // 5 block 4
+  });
+  llvm::FlowGraph graph(function);
+  ASSERT_EQ(5u, graph.blocks.size());
+  EXPECT_EQ(0u, graph.blocks[0].begin);
+  EXPECT_EQ(2u, graph.blocks[0].end);
+  EXPECT_EQ((std::vector<uint32_t>{1, 2}), graph.blocks[0].successors);
+  EXPECT_EQ((std::vector<uint32_t>{2}), graph.blocks[1].successors);
+  EXPECT_EQ((std::vector<uint32_t>{3, 4}), graph.blocks[2].successors);
+  EXPECT_EQ((std::vector<uint32_t>{0, 1}), graph.blocks[2].predecessors);
+  EXPECT_TRUE(graph.blocks[3].unknown_exit);
+  EXPECT_FALSE(graph.blocks[4].unknown_exit);
+  EXPECT_EQ(2u, graph.blockOf(3));
+  EXPECT_EQ(0u, graph.reversePostorder().front());
+  EXPECT_EQ(5u, graph.reversePostorder().size());
+  EXPECT_EQ(0x400003u, llvm::jump_target(function[1]));
+  EXPECT_EQ((bfd_vma) -1, llvm::jump_target(function[4]));
+}
+
+TEST(FlagsTest, Liveness) {
+  auto function = assembly({
+      "cmp    eax, ebx",
+      "jne    0x400003 <f+3>",
+      "cmp    eax, ecx",
+      "jb     0x400005 <f+5>",
+      "ret",
+      "ret",
+  });
+  auto live = llvm::flag_liveness(function, llvm::FlowGraph(function));
+  // CF of the first cmp reaches jb through jne
+  EXPECT_EQ(llvm::ZF | llvm::CF, live[0]);
+  EXPECT_EQ(llvm::CF, live[1]);
+  EXPECT_EQ(llvm::CF, live[2]);
+  EXPECT_EQ(0, live[3]);
+  EXPECT_EQ(0, live[4]);
+
+  // jump out of function keeps everything
+  auto out = assembly({"cmp    eax, ebx", "jmp    rax"});
+  EXPECT_EQ(llvm::ALL_FLAGS,
+            llvm::flag_liveness(out, llvm::FlowGraph(out))[0]);
+}
+
+TEST(FlagsTest, LiftOnlyLiveFlags) {
+  auto function = assembly({
+      "test   eax, ebx",
+      "je     0x400003 <f+3>",
+      "cmp    eax, ecx",
+      "ret",
+  });
+  // test + cmp without liveness
+  EXPECT_EQ(6u, lift(function, false).size());
+
+  // only ZF of test is read, cmp is not read at all
+  EXPECT_EQ((std::vector<std::string>{
+      "Temporary = (((DWORD)_eax)) AND (((DWORD)_ebx))",
+      "((BIT)_zf) = icmp eq Temporary, 0",
+  }), lift(function, true));
+}
+
+TEST(FlagsTest, BranchFusion) {
+  auto function = assembly({
+      "cmp    eax, ebx",
+      "jbe    0x400002 <f+2>",
+      "test   eax, eax",
+      "je     0x400004 <f+4>",
+      "ret",
+      "ret",
+  });
+  auto fused = lift(function, false, true);
+  ASSERT_EQ(4u, fused.size());
+  EXPECT_EQ("TempResult = icmp ule ((DWORD)_eax), ((DWORD)_ebx)", fused[0]);
+  EXPECT_EQ("TempResult = icmp eq ((DWORD)_eax), 0", fused[2]);
+  EXPECT_EQ(0u, fused[1].find("br TempResult"));
+  EXPECT_EQ(0u, fused[3].find("br TempResult"));
+
+  // ZF of cmp is read again after jb
+  auto live = assembly({
+      "cmp    eax, ebx",
+      "jb     0x400003 <f+3>",
+      "je     0x400004 <f+4>",
+      "ret",
+      "ret",
+  });
+  auto lifted = lift(live, false, true);
+  EXPECT_EQ(lift(live, false, false), lifted);
+  EXPECT_EQ(std::string::npos, lifted[0].find("TempResult"));
+}
+
+TEST(FlagsTest, PrefixedJumps) {
+  // indirect jumps leave function with every flag
+  for (auto jump : {"notrack jmp rax", "bnd jmp rax", "jmp    rax",
+                    "bnd jmp QWORD PTR [rip+0x2fe2]"}) {
+    auto function = assembly({"cmp    eax, ebx", jump, "ret"});
+    llvm::FlowGraph graph(function);
+    ASSERT_EQ(2u, graph.blocks.size()) << jump;
+    EXPECT_TRUE(graph.blocks[0].unknown_exit) << jump;
+    EXPECT_EQ(llvm::ALL_FLAGS, llvm::flag_liveness(function, graph)[0])
+        << jump;
+  }
+
+  // direct bnd jmp is followed to jne
+  auto direct = assembly({
+      "cmp    eax, ebx",
+      "bnd jmp 0x400003 <f+3>",
+      "ret",
+      "bnd jne 0x400002 <f+2>",
+      "ret",
+  });
+  llvm::FlowGraph graph(direct);
+  EXPECT_EQ(0x400003u, llvm::jump_target(direct[1]));
+  EXPECT_EQ(0x400002u, llvm::jump_target(direct[3]));
+  EXPECT_EQ((std::vector<uint32_t>{2}), graph.blocks[0].successors);
+  EXPECT_FALSE(graph.blocks[0].unknown_exit);
+  EXPECT_EQ(llvm::ZF, llvm::flag_liveness(direct, graph)[0]);
+
+  // jump behind prefix that is not known still ends block
+  auto unknown = assembly({"cmp    eax, ebx", "foo jmp 0x400002 <f+2>", "ret"});
+  llvm::FlowGraph hidden(unknown);
+  ASSERT_EQ(2u, hidden.blocks.size());
+  EXPECT_TRUE(hidden.blocks[0].unknown_exit);
+  EXPECT_EQ(llvm::ALL_FLAGS, llvm::flag_liveness(unknown, hidden)[0]);
+
+  // ZF read by jne is lifted
+  auto lifted = lift(direct, true);
+  ASSERT_FALSE(lifted.empty());
+  EXPECT_EQ("((BIT)_zf) = icmp eq ((DWORD)_eax), ((DWORD)_ebx)", lifted[0]);
+}
+}  // namespace
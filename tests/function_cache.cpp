@@ -0,0 +1,297 @@
+//
+// Created by miro on 10/18/26.
+//
+
+#include <gtest/gtest.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <befa.hpp>
+#include <befa/llvm/call.hpp>
+#include <befa/llvm/cmp.hpp>
+#include <befa/llvm/jmp.hpp>
+#include <befa/llvm/function_cache.hpp>
+
+#include "lift_fixture.hpp"
+
+namespace {
+
+using hash_t = llvm::FunctionCache::hash_t;
+using Instruction = ExecutableFile::inst_t::info::type;
+using BasicBlock = ExecutableFile::bb_t::info::type;
+using Symbol = ExecutableFile::sym_t::info::type;
+using SymbolMap = ExecutableFile::map_t::info::type;
+using SymbolTable = llvm::InstructionMapper::sym_table_t::type;
+
+struct DummySymbol
+    : public Symbol {
+  DummySymbol(std::string name, bfd_vma address)
+      : Symbol(nullptr, nullptr), name(name), address(address) {}
+
+  string getName() const override {
+    return name;
+  }
+
+  bfd_vma getAddress() const override {
+    return address;
+  }
+
+ private:
+  std::string name;
+  bfd_vma address;
+};
+
+hash_t digest(
+    std::vector<std::pair<std::vector<uint8_t>, bool>> instructions
+) {
+  llvm::FunctionCache::Hasher hasher;
+  for (auto &instruction : instructions)
+    hasher.add(
+        instruction.first.data(), instruction.first.size(), instruction.second
+    );
+  return hasher.digest();
+}
+
+TEST(FunctionCacheTest, HashMasksAddresses) {
+  // call rel32 to different targets
+  EXPECT_EQ(
+      digest({{{0xe8, 0x10, 0x00, 0x00, 0x00}, true}}),
+      digest({{{0xe8, 0x20, 0x30, 0x00, 0x00}, true}})
+  );
+  // opcode is not masked
+  EXPECT_NE(
+      digest({{{0xe8, 0x10, 0x00, 0x00, 0x00}, true}}),
+      digest({{{0xe9, 0x10, 0x00, 0x00, 0x00}, true}})
+  );
+  // bytes of instructions without address are not masked
+  EXPECT_NE(
+      digest({{{0x48, 0x83, 0xc0, 0x01}, false}}),
+      digest({{{0x48, 0x83, 0xc0, 0x02}, false}})
+  );
+  // boundaries between instructions matter
+  EXPECT_NE(
+      digest({{{0x90, 0x90}, false}, {{0x90}, false}}),
+      digest({{{0x90}, false}, {{0x90, 0x90}, false}})
+  );
+}
+
+TEST(FunctionCacheTest, HashMasksDisplacement) {
+  // mov DWORD PTR [rip+disp32], imm32 at two addresses, same target
+  auto mov = [](bfd_vma address, uint32_t immediate) {
+    bfd_vma target = 0x601040;
+    uint32_t disp = (uint32_t) (target - (address + 10));
+    std::vector<uint8_t> bytes{0xc7, 0x05};
+    for (int i = 0; i < 4; ++i)
+      bytes.push_back((uint8_t) (disp >> (i * 8)));
+    for (int i = 0; i < 4; ++i)
+      bytes.push_back((uint8_t) (immediate >> (i * 8)));
+    llvm::FunctionCache::Hasher hasher;
+    hasher.add(bytes.data(), bytes.size(), true, address, target);
+    return hasher.digest();
+  };
+  // displacement is masked, immediate is not
+  EXPECT_EQ(mov(0x400000, 1), mov(0x400100, 1));
+  EXPECT_NE(mov(0x400000, 1), mov(0x400000, 2));
+
+  // call rel32 at two addresses to the same target
+  auto call = [](bfd_vma address, bfd_vma target) {
+    uint32_t rel = (uint32_t) (target - (address + 5));
+    std::vector<uint8_t> bytes{0xe8};
+    for (int i = 0; i < 4; ++i)
+      bytes.push_back((uint8_t) (rel >> (i * 8)));
+    llvm::FunctionCache::Hasher hasher;
+    hasher.add(bytes.data(), bytes.size(), true, address, target);
+    return hasher.digest();
+  };
+  EXPECT_EQ(call(0x400000, 0x400800), call(0x400010, 0x400900));
+}
+
+TEST(FunctionCacheTest, HashKeyedByMachine) {
+  const uint8_t push[] = {0x55};
+  auto hash = [&push](uint32_t arch, uint64_t machine, std::string options) {
+    llvm::FunctionCache::Hasher hasher(arch, machine, options);
+    hasher.add(push, sizeof(push), false);
+    return hasher.digest();
+  };
+  EXPECT_EQ(hash(8, 1, "intel"), hash(8, 1, "intel"));
+  // i386 and x86-64 have the same arch, but another machine
+  EXPECT_NE(hash(8, 1, "intel"), hash(8, 2, "intel"));
+  EXPECT_NE(hash(8, 1, "intel"), hash(9, 1, "intel"));
+  EXPECT_NE(hash(8, 1, "intel"), hash(8, 1, "att"));
+}
+
+TEST(FunctionCacheTest, DirectoryRoundTrip) {
+  char directory[] = "/tmp/befa-cache-XXXXXX";
+  ASSERT_NE(mkdtemp(directory), nullptr);
+
+  llvm::FunctionCache::Entry entry;
+  entry.instructions.push_back({0, 1, false, false, (uint64_t) -1, "push   rbp"});
+  entry.instructions.push_back({1, 5, true, false, (uint64_t) -1, ""});
+  entry.instructions.push_back({6, 2, false, false, (uint64_t) -2, "jmp    rax"});
+
+  {
+    llvm::FunctionCache cache(directory);
+    cache.insert(42, entry);
+    EXPECT_EQ(1u, cache.size());
+  }
+
+  llvm::FunctionCache cache(directory);
+  EXPECT_EQ(0u, cache.size());
+  auto loaded = cache.find(42);
+  ASSERT_TRUE((bool) loaded);
+  EXPECT_EQ(nullptr, cache.find(43));
+  ASSERT_EQ(entry.instructions.size(), loaded->instructions.size());
+  for (size_t i = 0; i < entry.instructions.size(); ++i) {
+    EXPECT_EQ(entry.instructions[i].offset, loaded->instructions[i].offset);
+    EXPECT_EQ(entry.instructions[i].size, loaded->instructions[i].size);
+    EXPECT_EQ(
+        entry.instructions[i].relocatable, loaded->instructions[i].relocatable
+    );
+    EXPECT_EQ(entry.instructions[i].jump, loaded->instructions[i].jump);
+    EXPECT_EQ(entry.instructions[i].decoded, loaded->instructions[i].decoded);
+  }
+  // lifted instructions are kept in memory only
+  EXPECT_FALSE(loaded->has_lifted);
+
+  ::unlink(
+      (std::string(directory) + "/000000000000002a.bfc").c_str()
+  );
+  ::rmdir(directory);
+}
+
+const hash_t function_hash = 42;
+
+/**
+ * Decoded function at 0x400000, jbe is relocation-sensitive and call
+ * references function, so both of them are lifted again
+ */
+llvm::FunctionCache::Entry decoded_function() {
+  llvm::FunctionCache::Entry entry;
+  entry.instructions.push_back({0, 3, false, false, (uint64_t) -1, "cmp    eax, ebx"});
+  entry.instructions.push_back({3, 2, true, false, (uint64_t) -1, ""});
+  entry.instructions.push_back({5, 5, false, false, (uint64_t) -1, "call    0x400800"});
+  return entry;
+}
+
+/**
+ * Lifts function of decoded_function() through cache, 0x400800 is callee
+ *
+ * @param compare registers CompareFactory (cmp can be only replayed without)
+ * @param released if true, basic block is owned only by instructions and
+ *        function is lifted once it is complete (as in streaming mode)
+ * @return created instructions as text
+ */
+std::vector<std::string> lift_cached(
+    std::shared_ptr<llvm::FunctionCache> cache,
+    std::string callee,
+    bool compare,
+    bool released = false
+) {
+  auto symbol_map = std::make_shared<SymbolMap>(registers_map());
+  symbol_map->emplace(callee, std::make_shared<symbol_table::Function>(
+      std::make_shared<DummySymbol>(callee, 0x400800)
+  ));
+  llvm::InstructionMapper mapper(std::make_shared<llvm::SymTable>(symbol_map));
+  mapper.register_factories(
+      std::make_shared<llvm::CallFactory>(),
+      std::make_shared<llvm::JumpFactory>()
+  );
+  if (compare)
+    mapper.register_factory(std::make_shared<llvm::CompareFactory>());
+  mapper.set_function_cache(cache);
+  mapper.set_flag_liveness(released);
+
+  std::vector<std::string> lifted;
+  mapper.observable().subscribe([&lifted](
+      std::shared_ptr<llvm::VisitableBase> instr
+  ) {
+    lifted.push_back(map_visitable<llvm::SerializableVisitorL>(
+        instr, [](const llvm::Serializable *i) { return i->toString(); }
+    ));
+  });
+  rxcpp::subjects::subject<Instruction> i_subj;
+  mapper.reduce_instr(i_subj.get_observable())
+      .subscribe([](std::shared_ptr<SymbolTable>) {});
+
+  auto symbol = std::make_shared<DummySymbol>("f", 0x400000);
+  symbol->setContentHash(function_hash);
+  auto block = std::make_shared<BasicBlock>(0x400000, symbol);
+  std::shared_ptr<const void> owner;
+  if (released)
+    owner = block;
+  auto subscriber = i_subj.get_subscriber();
+  subscriber.on_next(Instruction({}, block, "cmp    eax, ebx", 0x400000, owner));
+  subscriber.on_next(Instruction({}, block, "jbe    0x0", 0x400003, owner));
+  subscriber.on_next(Instruction({}, block, "call    0x400800", 0x400005, owner));
+  if (released) {
+    block.reset();
+    owner.reset();
+  }
+  subscriber.on_completed();
+  return lifted;
+}
+
+TEST(FunctionCacheTest, ReplayLifted) {
+  auto cache = std::make_shared<llvm::FunctionCache>();
+  cache->insert(function_hash, decoded_function());
+
+  auto recorded = lift_cached(cache, "printf", true);
+  ASSERT_EQ(7u, recorded.size());
+  EXPECT_EQ("ResultOfTheCall = call @printf()", recorded.back());
+  auto entry = cache->find(function_hash);
+  ASSERT_TRUE(entry->has_lifted);
+  // cmp (2 compares) and call, jbe is relocatable
+  ASSERT_EQ(3u, entry->lifted.size());
+  EXPECT_EQ(5u, entry->lifted.back().first);
+  EXPECT_EQ(std::vector<uint32_t>{5}, entry->relift);
+
+  // cmp comes from cache, call is lifted against new symbols
+  auto replayed = lift_cached(cache, "puts", false);
+  ASSERT_EQ(recorded.size(), replayed.size());
+  EXPECT_EQ(
+      std::vector<std::string>(recorded.begin(), recorded.end() - 1),
+      std::vector<std::string>(replayed.begin(), replayed.end() - 1)
+  );
+  EXPECT_EQ("ResultOfTheCall = call @puts()", replayed.back());
+  EXPECT_EQ(entry, cache->find(function_hash));
+}
+
+TEST(FunctionCacheTest, ReleasedBlockIsOwned) {
+  auto cache = std::make_shared<llvm::FunctionCache>();
+  cache->insert(function_hash, decoded_function());
+
+  auto recorded = lift_cached(cache, "printf", true);
+  auto cache_released = std::make_shared<llvm::FunctionCache>();
+  cache_released->insert(function_hash, decoded_function());
+  // lifted after disassembler has released basic block
+  EXPECT_EQ(recorded, lift_cached(cache_released, "printf", true, true));
+  ASSERT_TRUE(cache_released->find(function_hash)->has_lifted);
+
+  auto replayed = lift_cached(cache_released, "puts", false, true);
+  ASSERT_EQ(recorded.size(), replayed.size());
+  EXPECT_EQ("ResultOfTheCall = call @puts()", replayed.back());
+}
+
+TEST(FunctionCacheTest, ReplacedCacheIsReleased) {
+  auto cache = std::make_shared<llvm::FunctionCache>();
+  std::weak_ptr<llvm::FunctionCache> released = cache;
+
+  llvm::InstructionMapper mapper(registers_table());
+  mapper.register_factory(std::make_shared<llvm::CompareFactory>());
+  mapper.set_function_cache(cache);
+  mapper.set_function_cache(std::make_shared<llvm::FunctionCache>());
+  mapper.set_function_cache(nullptr);
+  cache.reset();
+
+  rxcpp::subjects::subject<Instruction> i_subj;
+  mapper.reduce_instr(i_subj.get_observable())
+      .subscribe([](std::shared_ptr<SymbolTable>) {});
+  auto subscriber = i_subj.get_subscriber();
+  subscriber.on_next(Instruction(
+      {}, Instruction::bb_t::ptr::weak(), "cmp    eax, ebx", 0x400000
+  ));
+  subscriber.on_completed();
+  // nobody records into session of replaced cache
+  EXPECT_TRUE(released.expired());
+}
+}  // namespace
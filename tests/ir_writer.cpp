@@ -0,0 +1,150 @@
+//
+// Created by miro on 10/18/26.
+//
+
+#include <cstdio>
+#include <sstream>
+
+#include <gtest/gtest.h>
+
+#include <befa.hpp>
+#include <befa/llvm/call.hpp>
+#include <befa/llvm/cmp.hpp>
+#include <befa/llvm/jmp.hpp>
+#include <befa/llvm/compact.hpp>
+#include <befa/llvm/ir_writer.hpp>
+
+#include "lift_fixture.hpp"
+
+namespace {
+
+using Instruction = ExecutableFile::inst_t::info::type;
+using Symbol = std::shared_ptr<symbol_table::VisitableBase>;
+
+Symbol reg(const std::string &name) {
+  return Symbol(symbol_table::registers.at(name), symbol_table::register_deleter);
+}
+
+std::string to_string(const std::shared_ptr<llvm::VisitableBase> &instr) {
+  return map_visitable<llvm::SerializableVisitorL>(
+      instr, [](const llvm::Serializable *i) { return i->toString(); }
+  );
+}
+
+std::string written(const std::shared_ptr<llvm::VisitableBase> &instr) {
+  befa::ChunkedSink sink(3);
+  llvm::IrWriter(sink).write(instr);
+  return sink.str();
+}
+
+TEST(IrWriterTest, Sinks) {
+  befa::ChunkedSink chunked(4);
+  chunked << "_asm {" << '\n' << std::string(10, 'x');
+  EXPECT_EQ(5u, chunked.chunks().size());
+  EXPECT_EQ(17u, chunked.size());
+  EXPECT_EQ("_asm {\n" + std::string(10, 'x'), chunked.str());
+  EXPECT_EQ("", befa::ChunkedSink().str());
+
+  std::ostringstream stream;
+  {
+    befa::StreamSink sink(stream, 2);
+    sink << "br " << "TempResult";
+    EXPECT_EQ("br TempResul", stream.str());
+  }
+  EXPECT_EQ("br TempResult", stream.str());
+
+  FILE *file = std::tmpfile();
+  ASSERT_NE(nullptr, file);
+  {
+    befa::FdSink sink(fileno(file), 5);
+    for (int i = 0; i < 100; ++i)
+      sink << "line" << '\n';
+  }
+  std::rewind(file);
+  std::string text(500, '\0');
+  EXPECT_EQ(500u, std::fread(&text[0], 1, 600, file));
+  std::fclose(file);
+  EXPECT_EQ(0u, text.find("line\nline\n"));
+  EXPECT_EQ("line\n", text.substr(495));
+}
+
+TEST(IrWriterTest, SameAsToString) {
+  Instruction and_eax(
+      Instruction::bytes_t{}, Instruction::bb_t::ptr::weak(),
+      "and    eax, 0x0", 0x400000
+  );
+  Instruction::bytes_t nop_bytes{};
+  Instruction nop(
+      nop_bytes, Instruction::bb_t::ptr::weak(), "nop", 0x400001
+  );
+  auto result = std::make_shared<symbol_table::Symbol>("TempResult");
+  auto zero = std::make_shared<symbol_table::Immidiate>("0");
+  auto nested = std::make_shared<symbol_table::Temporary>(
+      reg("ebx"), "+", zero
+  );
+
+  std::vector<std::shared_ptr<llvm::VisitableBase>> instructions{
+      std::make_shared<llvm::BinaryOperation>(
+          llvm::Instruction::a_vec_t{and_eax}, reg("eax"), reg("eax"),
+          "AND", zero
+      ),
+      std::make_shared<llvm::BinaryOperation>(
+          llvm::Instruction::a_vec_t{and_eax}, reg("eax"), nullptr, "", nested
+      ),
+      std::make_shared<llvm::UnaryInstruction>(
+          llvm::Instruction::a_vec_t{and_eax}, reg("zf"), "MSB", nested
+      ),
+      std::make_shared<llvm::UnaryInstruction>(
+          llvm::Instruction::a_vec_t{and_eax}, reg("zf"), "", reg("eax")
+      ),
+      std::make_shared<llvm::CmpInstruction>(
+          and_eax, result, reg("eax"), llvm::CmpInstruction::ULE, zero
+      ),
+      std::make_shared<llvm::CallInstruction>(
+          llvm::Instruction::a_vec_t{and_eax}, reg("eax"), nested
+      ),
+      std::make_shared<llvm::BranchInstruction>(
+          llvm::Instruction::a_vec_t{and_eax}, result, zero
+      ),
+  };
+  for (auto &instruction : instructions)
+    EXPECT_EQ(to_string(instruction), written(instruction));
+
+  // assembly of instruction
+  auto binary = std::make_shared<llvm::BinaryOperation>(
+      llvm::Instruction::a_vec_t{and_eax, nop}, reg("eax"), reg("eax"),
+      "AND", zero
+  );
+  befa::ChunkedSink sink(5);
+  llvm::IrWriter(sink).writeAssembly(*binary);
+  EXPECT_EQ(binary->llvm::Instruction::toString(), sink.str());
+  EXPECT_EQ("_asm {\n\tand\n\tnop\n}\n", sink.str());
+}
+
+TEST(IrWriterTest, CompactFunction) {
+  auto function = assembly({
+      "test   eax, ebx",
+      "jbe    0x400003 <f+3>",
+      "cmp    eax, ecx",
+      "ret",
+  });
+  llvm::InstructionMapper mapper(registers_table());
+  mapper.register_factories(
+      std::make_shared<llvm::CompareFactory>(),
+      std::make_shared<llvm::JumpFactory>()
+  );
+  auto compact = mapper.lift_compact(function);
+  ASSERT_LT(5u, compact->size());
+
+  std::string expected;
+  for (size_t index = 0; index < compact->size(); ++index) {
+    befa::ChunkedSink sink;
+    llvm::IrWriter(sink).write(*compact, index);
+    EXPECT_EQ(to_string(compact->view(index)), sink.str());
+    expected += sink.str() + "\n";
+  }
+  befa::ChunkedSink sink(7);
+  llvm::IrWriter(sink).write(*compact);
+  EXPECT_EQ(expected, sink.str());
+}
+}  // namespace
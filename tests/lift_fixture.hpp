@@ -0,0 +1,51 @@
+//
+// Created by miro on 10/18/26.
+//
+
+#ifndef BEFA_LIFT_FIXTURE_HPP
+#define BEFA_LIFT_FIXTURE_HPP
+
+#include <befa.hpp>
+
+/**
+ * Instructions at 0x400000, 0x400001, ...
+ */
+inline std::vector<ExecutableFile::inst_t::info::type> assembly(
+    std::vector<std::string> decoded
+) {
+  using Instruction = ExecutableFile::inst_t::info::type;
+  std::vector<Instruction> function;
+  bfd_vma address = 0x400000;
+  for (auto &text : decoded)
+    function.emplace_back(
+        Instruction::bytes_t{}, Instruction::bb_t::ptr::weak(), text, address++
+    );
+  return function;
+}
+
+/**
+ * @return symbol map of registers (they are static, so they are not deleted)
+ */
+inline ExecutableFile::map_t::info::type registers_map() {
+  return ::map(symbol_table::registers, [](
+      std::pair<std::string, symbol_table::VisitableBase *> _reg
+  ) {
+    return std::make_pair(
+        _reg.first,
+        std::shared_ptr<symbol_table::VisitableBase>(
+            _reg.second,
+            symbol_table::register_deleter
+        ));
+  }, ExecutableFile::map_t::info::type());
+}
+
+/**
+ * @return symbol table of registers for InstructionMapper
+ */
+inline std::shared_ptr<llvm::SymTable> registers_table() {
+  return std::make_shared<llvm::SymTable>(
+      std::make_shared<ExecutableFile::map_t::info::type>(registers_map())
+  );
+}
+
+#endif //BEFA_LIFT_FIXTURE_HPP
@@ -0,0 +1,210 @@
+//
+// Created by miro on 10/18/26.
+//
+
+#include <gtest/gtest.h>
+#include <random>
+#include <regex>
+#include <sstream>
+#include <typeinfo>
+
+#include <befa.hpp>
+#include <befa/assembly/instruction_parser.hpp>
+#include <befa/assembly/instruction.hpp>
+
+namespace {
+
+using sym_t = instruction_parser::sym_t;
+using sym_map_t = instruction_parser::sym_map_t;
+
+struct OperandInstruction
+    : public instruction_parser {
+  OperandInstruction(std::string operand)
+      : operand(operand) {}
+
+  piece_t::rx::obs parse() const override {
+    return rxcpp::sources::iterate(std::vector<std::string>{"op", operand});
+  }
+
+ private:
+  std::string operand;
+};
+
+/**
+ * Former std::regex implementation of instruction_parser::handle_expression,
+ * kept as reference for the hand-written scanner
+ */
+struct RegexParser {
+  RegexParser(sym_map_t::c::ref functions) : functions(functions) {}
+
+  sym_t::ptr::shared handle(const std::string &expr) const {
+    static const std::regex multiplication("(.+)(\\*)(.+)");
+    static const std::regex add_or_substract("(.+)(\\+|\\-)(.+)");
+    static const std::regex dereference(
+        "(XMMWORD|BYTE|WORD|DWORD|QWORD) PTR (?:\\w+:)?\\[(.*)\\]"
+    );
+    static const std::regex number("((?:0x0*)?[0-9a-fA-F]+)");
+    static const std::regex address("(?:0x)?0*([0-9a-fA-F]+)");
+
+    std::smatch result;
+    if (std::regex_match(expr, result, address)) {
+      auto function = functions.find(str_to_vma(result.str(1)));
+      if (function != functions.cend())
+        return function->second;
+    }
+    auto reg = symbol_table::registers.find(expr);
+    if (reg != symbol_table::registers.end())
+      return sym_t::ptr::shared(reg->second, symbol_table::register_deleter);
+    if (std::regex_match(expr, result, number))
+      return std::make_shared<symbol_table::Immidiate>(result.str(1));
+    if (std::regex_match(expr, result, dereference))
+      return create_dereference(result.str(1), result.str(2));
+    if (std::regex_match(expr, result, multiplication)
+        || std::regex_match(expr, result, add_or_substract))
+      return std::make_shared<symbol_table::Temporary>(
+          handle(result.str(1)), result.str(2), handle(result.str(3))
+      );
+    return std::make_shared<symbol_table::Symbol>(expr);
+  }
+
+ private:
+  static bfd_vma str_to_vma(std::string input) {
+    std::stringstream ss;
+    bfd_vma result;
+    static_cast<std::stringstream &>(
+        ss << std::hex << input
+    ) >> std::hex >> result;
+    return result;
+  }
+
+  sym_t::ptr::shared create_dereference(
+      const std::string &size,
+      const std::string &expr
+  ) const {
+    using symbol_table::SizedTemporary;
+    namespace types = symbol_table::types;
+    if (size == "BYTE")
+      return std::make_shared<SizedTemporary<types::BYTE>>("*", handle(expr));
+    if (size == "WORD")
+      return std::make_shared<SizedTemporary<types::WORD>>("*", handle(expr));
+    if (size == "DWORD")
+      return std::make_shared<SizedTemporary<types::DWORD>>("*", handle(expr));
+    if (size == "QWORD")
+      return std::make_shared<SizedTemporary<types::QWORD>>("*", handle(expr));
+    return std::make_shared<SizedTemporary<types::XMM>>("*", handle(expr));
+  }
+
+  sym_map_t::c::ref functions;
+};
+
+sym_t::ptr::shared parse(
+    const std::string &operand,
+    sym_map_t::c::ref functions
+) {
+  sym_t::ptr::shared parsed;
+  OperandInstruction(operand).getArgs(functions)
+      .subscribe([&parsed](sym_t::ptr::shared symbol) { parsed = symbol; });
+  return parsed;
+}
+
+void expect_same(
+    const std::string &operand,
+    const sym_t::ptr::shared &expected,
+    const sym_t::ptr::shared &actual
+) {
+  ASSERT_TRUE((bool) expected) << operand;
+  ASSERT_TRUE((bool) actual) << operand;
+  EXPECT_EQ(typeid(*expected), typeid(*actual)) << operand;
+
+  auto expected_symbol = dynamic_cast<const symbol_table::Symbol *>(expected.get());
+  auto actual_symbol = dynamic_cast<const symbol_table::Symbol *>(actual.get());
+  ASSERT_NE(nullptr, expected_symbol) << operand;
+  ASSERT_NE(nullptr, actual_symbol) << operand;
+  EXPECT_EQ(expected_symbol->getName(), actual_symbol->getName()) << operand;
+
+  // registers and functions are shared, not created
+  if (dynamic_cast<const symbol_table::RegisterBase *>(expected.get())
+      || dynamic_cast<const symbol_table::Function *>(expected.get()))
+    EXPECT_EQ(expected.get(), actual.get()) << operand;
+
+  auto expected_temp = dynamic_cast<const symbol_table::Temporary *>(expected.get());
+  auto actual_temp = dynamic_cast<const symbol_table::Temporary *>(actual.get());
+  if (expected_temp && actual_temp) {
+    EXPECT_EQ(expected_temp->getOperator(), actual_temp->getOperator()) << operand;
+    EXPECT_EQ(
+        (bool) expected_temp->getLeft(), (bool) actual_temp->getLeft()
+    ) << operand;
+    if (expected_temp->getLeft() && actual_temp->getLeft())
+      expect_same(operand, expected_temp->getLeft(), actual_temp->getLeft());
+    expect_same(operand, expected_temp->getRight(), actual_temp->getRight());
+  }
+}
+
+struct DummySymbol
+    : public ExecutableFile::sym_t::info::type {
+  DummySymbol(bfd_vma address, std::string name)
+      : ExecutableFile::sym_t::info::type(
+            nullptr, std::make_shared<befa::Section>(nullptr)
+        ), address(address), name(name) {}
+
+  bfd_vma getAddress() const override { return address; }
+
+  std::string getName() const override { return name; }
+
+ private:
+  bfd_vma address;
+  std::string name;
+};
+
+sym_map_t::info::type create_functions() {
+  sym_map_t::info::type functions;
+  for (auto &function : std::vector<std::pair<bfd_vma, std::string>>{
+      {0x666, "beast"}, {0x400, "start"}, {0xadd, "add"}, {0, "null"}
+  })
+    functions.emplace(function.first, std::make_shared<symbol_table::Function>(
+        std::make_shared<DummySymbol>(function.first, function.second)
+    ));
+  return functions;
+}
+
+TEST(OperandParserTest, MatchesRegexImplementation) {
+  auto functions = create_functions();
+  RegexParser reference(functions);
+  for (std::string operand : {
+      "", "eax", "rax", "al", "_eax", "xmm0", "rip", "0", "00", "0x", "0x0",
+      "0x000", "0x666", "666", "0000666", "0x400", "400", "add", "dead",
+      "0xg", "0X10", "ffffffffffffffff", "10000000000000000",
+      "DWORD PTR [eax*0x8+0x666]", "XMMWORD PTR [eax*0x8+0x666]",
+      "QWORD PTR [rbp-0x8]", "BYTE PTR [rip+0x200b41]",
+      "QWORD PTR fs:0x28", "DWORD PTR fs:[rax]", "WORD PTR ds:[rsi+rcx*1]",
+      "YMMWORD PTR [rax]", "DWORD PTR [rax", "DWORD PTR []", "DWORD PTR :[rax]",
+      "DWORD PTR [rax]+QWORD PTR [rbx]", "DWORD  PTR [rax]", "dword PTR [rax]",
+      "rax+rbx*4+0x10", "a*b*", "*a", "a*", "+", "-", "-0x8", "a--b", "a+-b",
+      "rax+", "+rax", "**", "a**b", "cs:0x0", "4009b0 <main+0x10>",
+      "rax\n+rbx", "DWORD PTR [rax\n]", "QWORD PTR [rax\r+8]"
+  })
+    expect_same(operand, reference.handle(operand), parse(operand, functions));
+}
+
+TEST(OperandParserTest, MatchesRegexImplementationOnRandomInput) {
+  static const std::vector<std::string> tokens{
+      "rax", "eax", "al", "xmm1", "0x", "0", "8", "f", "ff", "666", "400",
+      "*", "+", "-", "[", "]", " ", "PTR ", "DWORD ", "QWORD ", "XMMWORD ",
+      "fs:", "ds", ":", "x", "_", "\n"
+  };
+  auto functions = create_functions();
+  RegexParser reference(functions);
+  std::mt19937 random(0xbefa);
+  std::uniform_int_distribution<size_t> count(1, 8);
+  std::uniform_int_distribution<size_t> token(0, tokens.size() - 1);
+  for (int i = 0; i < 2000; ++i) {
+    std::string operand;
+    for (size_t n = count(random); n > 0; --n)
+      operand += tokens[token(random)];
+    // make sure there are dereferences among them
+    if (i % 4 == 0)
+      operand = "DWORD PTR [" + operand + "]";
+    expect_same(operand, reference.handle(operand), parse(operand, functions));
+  }
+}
+}  // namespace
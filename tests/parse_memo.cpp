@@ -0,0 +1,147 @@
+//
+// Created by miro on 10/18/26.
+//
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <gtest/gtest.h>
+
+#include <befa.hpp>
+#include <befa/assembly/instruction.hpp>
+#include <befa/assembly/parse_memo.hpp>
+
+namespace {
+
+using sym_t = instruction_parser::sym_t;
+using sym_map_t = instruction_parser::sym_map_t;
+
+struct dummy_parent {};
+
+struct MemoInstruction
+    : public befa::Instruction<dummy_parent> {
+  MemoInstruction(const std::string &decoded)
+      : befa::Instruction<dummy_parent>({}, bb_t::ptr::weak(), decoded, 0) {}
+};
+
+struct DummySymbol
+    : public ExecutableFile::sym_t::info::type {
+  DummySymbol(bfd_vma address)
+      : ExecutableFile::sym_t::info::type(
+            nullptr, std::make_shared<befa::Section>(nullptr)
+        ), address(address) {}
+
+  bfd_vma getAddress() const override { return address; }
+
+  std::string getName() const override { return "dummy"; }
+
+ private:
+  bfd_vma address;
+};
+
+std::string name(const sym_t::ptr::shared &symbol) {
+  return dynamic_cast<const symbol_table::Symbol &>(*symbol).getName();
+}
+
+sym_t::vector::shared parse(
+    const std::string &decoded,
+    const std::shared_ptr<befa::ParseMemo> &memo,
+    sym_map_t::c::ref functions = {}
+) {
+  sym_t::vector::shared args;
+  MemoInstruction(decoded)
+      .getArgs(functions, std::make_shared<symbol_table::ExpressionPool>(
+          nullptr, memo
+      ))
+      .subscribe([&args](auto arg) { args.push_back(arg); });
+  return args;
+}
+
+TEST(ParseMemoTest, ReusesOperands) {
+  auto memo = std::make_shared<befa::ParseMemo>();
+  auto first = parse("mov    QWORD PTR [rbp-0x8],rax", memo);
+  auto second = parse("add    QWORD PTR [rbp-0x8],rax", memo);
+  ASSERT_EQ(2u, first.size());
+  EXPECT_EQ(first, second);
+  EXPECT_EQ(1u, memo->size());
+  EXPECT_EQ(1u, memo->hits());
+  EXPECT_EQ(1u, memo->misses());
+
+  // operands without memo are the same
+  auto plain = parse("mov    QWORD PTR [rbp-0x8],rax", nullptr);
+  ASSERT_EQ(first.size(), plain.size());
+  for (size_t i = 0; i < plain.size(); ++i)
+    EXPECT_EQ(name(plain[i]), name(first[i]));
+
+  // instructions without operands are not stored
+  EXPECT_TRUE(parse("ret", memo).empty());
+  EXPECT_EQ(1u, memo->size());
+}
+
+TEST(ParseMemoTest, EvictsLeastRecentlyUsed) {
+  auto memo = std::make_shared<befa::ParseMemo>(2);
+  auto rax = parse("push   rax", memo);
+  parse("push   rbx", memo);
+  parse("push   rax", memo);
+  parse("push   rcx", memo);
+  EXPECT_EQ(2u, memo->size());
+  EXPECT_EQ(1u, memo->hits());
+  // rbx has been evicted, rax not
+  EXPECT_EQ(rax, parse("push   rax", memo));
+  EXPECT_EQ(2u, memo->hits());
+  parse("push   rbx", memo);
+  EXPECT_EQ(2u, memo->hits());
+}
+
+TEST(ParseMemoTest, ResolvesFunctions) {
+  auto memo = std::make_shared<befa::ParseMemo>();
+  sym_map_t::info::type functions;
+  functions.emplace(0x400, std::make_shared<symbol_table::Function>(
+      std::make_shared<DummySymbol>(0x400)
+  ));
+
+  auto number = parse("call   400", memo);
+  ASSERT_EQ(1u, number.size());
+  EXPECT_NE(nullptr, dynamic_cast<symbol_table::Immidiate *>(number[0].get()));
+
+  // stored number is parsed again, when there is function
+  auto function = parse("call   400", memo, functions);
+  ASSERT_EQ(1u, function.size());
+  EXPECT_EQ(functions[0x400], function[0]);
+
+  // operands with functions are not stored
+  memo = std::make_shared<befa::ParseMemo>();
+  parse("call   400", memo, functions);
+  EXPECT_EQ(0u, memo->size());
+  EXPECT_EQ(number.size(), parse("call   400", memo).size());
+  EXPECT_EQ(1u, memo->size());
+}
+
+TEST(ParseMemoTest, ParsesWithoutLock) {
+  befa::ParseMemo memo;
+  std::atomic<int> parsing{0};
+  std::atomic<int> concurrent{0};
+  auto parse = [&](befa::ParseMemo::pool_t::ref pool) {
+    ++parsing;
+    // waits for the other thread to be parsing too
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (parsing < 2 && std::chrono::steady_clock::now() < deadline)
+      std::this_thread::yield();
+    concurrent = std::max<int>(concurrent, parsing);
+    return sym_t::vector::shared{
+        pool.leaf<symbol_table::Symbol>("rax")
+    };
+  };
+
+  sym_t::vector::shared first, second;
+  std::thread other([&] { first = memo.get("rax", {}, parse); });
+  second = memo.get("rax", {}, parse);
+  other.join();
+  EXPECT_EQ(2, concurrent);
+  // the same text parsed twice is stored once
+  EXPECT_EQ(1u, memo.size());
+  EXPECT_NE(first[0], second[0]);
+  auto stored = memo.get("rax", {}, parse);
+  EXPECT_TRUE(stored == first || stored == second);
+}
+}  // namespace
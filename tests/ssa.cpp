@@ -0,0 +1,185 @@
+//
+// Created by miro on 10/18/26.
+//
+
+#include <algorithm>
+
+#include <gtest/gtest.h>
+
+#include <befa.hpp>
+#include <befa/llvm/call.hpp>
+#include <befa/llvm/cmp.hpp>
+#include <befa/llvm/jmp.hpp>
+#include <befa/llvm/ssa.hpp>
+
+#include "lift_fixture.hpp"
+
+namespace {
+
+using Instruction = ExecutableFile::inst_t::info::type;
+
+std::shared_ptr<llvm::CompactFunction> lift(
+    const std::vector<Instruction> &function
+) {
+  llvm::InstructionMapper mapper(registers_table());
+  mapper.register_factories(
+      std::make_shared<llvm::CompareFactory>(),
+      std::make_shared<llvm::JumpFactory>()
+  );
+  return mapper.lift_compact(function);
+}
+
+std::string name(const llvm::SsaForm &ssa, llvm::SsaForm::value_id value) {
+  return dynamic_cast<const symbol_table::Symbol *>(
+      ssa.variable(ssa.value(value).variable).get()
+  )->getName();
+}
+
+/**
+ * Every use -> def has its def -> use and the other way around
+ */
+void expect_linked(const llvm::SsaForm &ssa, size_t records) {
+  auto has_user = [&ssa](
+      llvm::SsaForm::value_id value,
+      llvm::SsaForm::kind_e kind,
+      uint32_t user,
+      uint32_t operand
+  ) {
+    auto users = ssa.usersOf(value);
+    return std::any_of(users.begin(), users.end(), [&](auto &use) {
+      return use.kind == kind && use.user == user && use.operand == operand;
+    });
+  };
+  size_t uses = 0;
+  for (uint32_t r = 0; r < records; ++r) {
+    uint32_t k = 0;
+    for (auto value : ssa.usesOf(r)) {
+      EXPECT_TRUE(has_user(value, llvm::SsaForm::RECORD, r, k++));
+      ++uses;
+    }
+    for (auto value : ssa.definedBy(r)) {
+      EXPECT_EQ(llvm::SsaForm::RECORD, ssa.value(value).kind);
+      EXPECT_EQ(r, ssa.value(value).position);
+    }
+  }
+  for (uint32_t p = 0; p < ssa.phiCount(); ++p) {
+    uint32_t k = 0;
+    for (auto value : ssa.operandsOf(p)) {
+      if (value != llvm::SsaForm::no_value) {
+        EXPECT_TRUE(has_user(value, llvm::SsaForm::PHI, p, k));
+        ++uses;
+      }
+      ++k;
+    }
+  }
+  size_t linked = 0;
+  for (uint32_t value = 0; value < ssa.valueCount(); ++value)
+    linked += ssa.usersOf(value).size();
+  EXPECT_EQ(uses, linked);
+}
+
+TEST(SsaTest, PhisOnJoin) {
+  auto function = assembly({
+      "cmp    eax, ebx",         // block 0
+      "jbe    0x400003 <f+3>",
+      "cmp    eax, ecx",         // block 1
+      "jbe    0x400005 <f+5>",   // block 2 reads flags of both cmp
+      "ret",
+      "ret",
+  });
+  auto lifted = lift(function);
+  llvm::SsaForm ssa(function, *lifted);
+  expect_linked(ssa, lifted->size());
+
+  EXPECT_EQ(0u, ssa.immediateDominator(2));
+  EXPECT_EQ(0u, ssa.immediateDominator(1));
+  EXPECT_EQ(0u, ssa.immediateDominator(0));
+
+  // only cf and zf are read by the second jbe
+  ASSERT_EQ(2u, ssa.phiCount());
+  std::vector<std::string> merged;
+  for (uint32_t p = 0; p < ssa.phiCount(); ++p) {
+    EXPECT_EQ(2u, ssa.phi(p).block);
+    merged.push_back(name(ssa, ssa.phi(p).result));
+    auto operands = ssa.operandsOf(p);
+    ASSERT_EQ(2, operands.size());
+    EXPECT_EQ(0u, ssa.blockOfRecord(ssa.value(operands.begin()[0]).position));
+    EXPECT_EQ(1u, ssa.blockOfRecord(ssa.value(operands.begin()[1]).position));
+    EXPECT_LT(0, ssa.usersOf(ssa.phi(p).result).size());
+  }
+  std::sort(merged.begin(), merged.end());
+  EXPECT_EQ((std::vector<std::string>{"((BIT)_cf)", "((BIT)_zf)"}), merged);
+  EXPECT_EQ((std::make_pair<uint32_t, uint32_t>(0, 2)), ssa.phisOf(2));
+
+  // eax is never defined, both cmp read the same value
+  auto eax = std::find_if(
+      ssa.usesOf(0).begin(), ssa.usesOf(0).end(),
+      [&](llvm::SsaForm::value_id value) {
+        return name(ssa, value) == "((DWORD)_eax)";
+      }
+  );
+  ASSERT_NE(ssa.usesOf(0).end(), eax);
+  EXPECT_EQ(llvm::SsaForm::LIVE_IN, ssa.value(*eax).kind);
+  auto users = ssa.usersOf(*eax);
+  EXPECT_TRUE(std::any_of(users.begin(), users.end(), [&](auto &use) {
+    return ssa.blockOfRecord(use.user) == 1;
+  }));
+}
+
+TEST(SsaTest, LoopToEntry) {
+  auto function = assembly({
+      "jbe    0x400002 <f+2>",   // block 0 reads flags from outside or loop
+      "cmp    eax, ebx",         // block 1
+      "jbe    0x400000 <f>",     // block 2
+      "ret",
+  });
+  auto lifted = lift(function);
+  llvm::SsaForm ssa(function, *lifted);
+  expect_linked(ssa, lifted->size());
+
+  // cf and zf in entry and in block 2
+  ASSERT_EQ(4u, ssa.phiCount());
+  EXPECT_EQ((std::make_pair<uint32_t, uint32_t>(0, 2)), ssa.phisOf(0));
+  EXPECT_EQ((std::make_pair<uint32_t, uint32_t>(2, 4)), ssa.phisOf(2));
+  for (uint32_t p = 0; p < 2; ++p) {
+    auto operands = ssa.operandsOf(p);
+    // from block 2 and from outside of function
+    ASSERT_EQ(2, operands.size());
+    EXPECT_EQ(llvm::SsaForm::PHI, ssa.value(operands.begin()[0]).kind);
+    EXPECT_EQ(2u, ssa.phi(ssa.value(operands.begin()[0]).position).block);
+    EXPECT_EQ(llvm::SsaForm::LIVE_IN, ssa.value(operands.begin()[1]).kind);
+  }
+  for (uint32_t p = 2; p < 4; ++p) {
+    auto operands = ssa.operandsOf(p);
+    ASSERT_EQ(2, operands.size());
+    EXPECT_EQ(llvm::SsaForm::PHI, ssa.value(operands.begin()[0]).kind);
+    EXPECT_EQ(llvm::SsaForm::RECORD, ssa.value(operands.begin()[1]).kind);
+  }
+}
+
+TEST(SsaTest, UnreachablePredecessor) {
+  auto function = assembly({
+      "cmp    eax, ebx",         // block 0
+      "jbe    0x400005 <f+5>",
+      "cmp    eax, ecx",         // block 1
+      "jmp    0x400005 <f+5>",
+      "cmp    eax, edx",         // block 2 is unreachable
+      "jbe    0x400007 <f+7>",   // block 3 joins 0, 1 and 2
+      "ret",
+      "ret",
+  });
+  auto lifted = lift(function);
+  llvm::SsaForm ssa(function, *lifted);
+  expect_linked(ssa, lifted->size());
+
+  ASSERT_EQ(2u, ssa.phiCount());
+  for (uint32_t p = 0; p < ssa.phiCount(); ++p) {
+    EXPECT_EQ(3u, ssa.phi(p).block);
+    auto operands = ssa.operandsOf(p);
+    ASSERT_EQ(3, operands.size());
+    EXPECT_EQ(0u, ssa.blockOfRecord(ssa.value(operands.begin()[0]).position));
+    EXPECT_EQ(1u, ssa.blockOfRecord(ssa.value(operands.begin()[1]).position));
+    EXPECT_EQ(llvm::SsaForm::no_value, operands.begin()[2]);
+  }
+}
+}  // namespace
@@ -0,0 +1,69 @@
+//
+// Created by miro on 10/18/26.
+//
+
+#include <gtest/gtest.h>
+#include <random>
+
+#include <befa/assembly/instruction.hpp>
+
+namespace {
+
+std::vector<std::string> pieces(
+    const std::string &text,
+    const std::vector<befa::details::piece_slice> &slices
+) {
+  std::vector<std::string> pieces;
+  for (auto &slice : slices)
+    pieces.push_back(text.substr(slice.offset, slice.length));
+  return pieces;
+}
+
+void expect_same(const std::string &text) {
+  std::vector<befa::details::piece_slice> slices;
+  befa::tokenize(text, slices);
+  EXPECT_EQ(
+      pieces(text, befa::details::split(text, befa::parse_regex)),
+      pieces(text, slices)
+  ) << "'" << text << "'";
+}
+
+TEST(TokenizerTest, MatchesRegex) {
+  for (std::string text : {
+      "", "ret", "ret    ", "nop", "push   rbp", "mov    rbp,rsp",
+      "mov    eax,DWORD PTR [rbp-0x4]", "mov    QWORD PTR [rbp-0x8],0x0",
+      "mov    rax,QWORD PTR fs:0x28", "mov    DWORD PTR fs:[rax],0x1",
+      "movsx  eax,BYTE PTR ds:[rsi+rcx*1]", "lea    rdi,[rip+0x200b41]",
+      "jmp    QWORD PTR [rip+0x200a12]        # 601018 <_GLOBAL_OFFSET_TABLE_+0x18>",
+      "lea    rax,[rip+0xe9c]        # 0x400f50", "call   400430 <puts@plt>",
+      "jne    4009b0 <main+0x10>", "nop    WORD PTR cs:[rax+rax*1+0x0]",
+      "data16 nop WORD PTR cs:0x0[rax+rax*1]", "rep stos QWORD PTR es:[rdi],rax",
+      "movss  xmm0,DWORD PTR [rip+0x0]", "cvtsi2sd xmm0,eax", "bnd jmp rax",
+      "call   *0x8(%rax)", "a.b", ".a", "a.", "..a", "a.b.c", "0x", "0x0",
+      "0x00ff", "0xg", "00x1", "# 0x", "# 0x0", "# 0xg", "#  0x1", "[", "[]",
+      "[a]", "[[a]]", "[a]]", "a PTR [b]", "a PTR []", "a PTR [b", "a PTR x:[b]",
+      "a PTR x:y", "a PTR :[b]", "a  PTR [b]", "a PTR\n[b]", "[a\nb]",
+      "\xe9\xff mov", "x.\xe9", "_", "__a__", "0x1.a", "a.0x1"
+  })
+    expect_same(text);
+}
+
+TEST(TokenizerTest, MatchesRegexOnRandomInput) {
+  static const std::vector<std::string> tokens{
+      "mov", "rax", "eax", "0x", "0", "f", "00", "g", "x", "_", ".", "#", "# 0x",
+      " ", ",", "[", "]", " PTR ", "DWORD", "fs", ":", "+", "-", "*", "<", ">",
+      "@", "\n", "\xe9"
+  };
+  std::mt19937 random(0xbefa);
+  std::uniform_int_distribution<size_t> token(0, tokens.size() - 1);
+  for (size_t length : {4, 16, 60, 200}) {
+    std::uniform_int_distribution<size_t> count(0, length);
+    for (int i = 0; i < 500; ++i) {
+      std::string text;
+      for (size_t n = count(random); n > 0; --n)
+        text += tokens[token(random)];
+      expect_same(text);
+    }
+  }
+}
+}  // namespace